@@ -2,9 +2,11 @@
 #include "net/rime/rime.h"
 #include "random.h"
 #include "sys/node-id.h" // For node_id
+#include "dev/serial-line.h" // Sensor energy report on request
 #include <stdio.h>
 #include <math.h>   // For sqrt, pow (for distance), ceil, log2
 #include <string.h> // For memcpy, memset
+#include <stddef.h> // For offsetof
 
 // --- Global Defines and Constants ---
 // Node Types - ONLY ONE OF THESE SHOULD BE UNCOMMENTED OR DEFINED IN Makefile.cooja
@@ -58,9 +60,28 @@
 
 // Communication Channels/Ports for Rime
 #define BROADCAST_CHANNEL 123
-#define ROBOT_TO_BS_UNICAST_PORT 3000
+#define ROBOT_TO_BS_REPORT_PORT 3000 // Runicast: Robot_pM from robots to the BS, acked by the BS
 #define SENSOR_TO_ROBOT_UNICAST_PORT 3001
-#define ROBOT_TO_SENSOR_ACTIVATION_PORT 3002 // For robots to tell sensors to become active/idle
+#define ROBOT_TO_SENSOR_COMMAND_CHANNEL 3002 // Broadcast: one collect/activate command frame per grid
+#define BS_TO_ROBOT_ASSIGNMENT_PORT 3003 // Runicast: LA assignments from BS to robots, acked by the robot
+#define SENSOR_TO_ROBOT_ACK_PORT 3004 // Sensor acks of grid command frames
+
+// LA assignment delivery: runicast retransmits up to ASSIGNMENT_MAX_RETRANSMISSIONS times,
+// then the BS retries the whole send after ASSIGNMENT_RETRY_INTERVAL
+#define ASSIGNMENT_MAX_RETRANSMISSIONS 4
+#define ASSIGNMENT_RETRY_INTERVAL (CLOCK_SECOND * 2)
+
+// Robot_pM delivery works the same way: the BS only reassigns a robot on its report,
+// so the robot retries after REPORT_RETRY_INTERVAL until the BS acks it or a new LA arrives
+#define REPORT_MAX_RETRANSMISSIONS 4
+#define REPORT_RETRY_INTERVAL (CLOCK_SECOND * 2)
+
+// Grid commands: the robot rebroadcasts a grid's frame up to GRID_COMMAND_MAX_RETRIES times
+// while entries are unacked, waiting GRID_COMMAND_ACK_WAIT for acks after each send
+#define GRID_COMMAND_MAX_ENTRIES (ROBOT_STOCK_CAPACITY + 1) // Collects fill the stock, plus one activation
+#define GRID_COMMAND_ACK_BYTES ((GRID_COMMAND_MAX_ENTRIES + 7) / 8)
+#define GRID_COMMAND_MAX_RETRIES 2
+#define GRID_COMMAND_ACK_WAIT (CLOCK_SECOND / 4)
 
 // Energy Model Constants (Assumed values - tune for realism)
 // Power values in Watts (W)
@@ -106,6 +127,8 @@ typedef struct {
 typedef struct {
     int robot_id;
     int assigned_la_id;
+    int assignment_pending; // 1 until the robot acks its current assignment
+    int last_report_seqno; // Runicast seqno of the last accepted Robot_pM, -1 before the first
 } robot_db_record_t;
 
 // Grid_DB record (on Robot)
@@ -124,12 +147,19 @@ typedef struct {
 
 // --- Message Formats ---
 
-// Robot_pM (Robot to BS)
+// Robot_pM (Robot to BS over runicast)
 typedef struct {
     int robot_id;
     int covered_grids_in_la; // Cov_G
 } robot_pm_msg_t;
 
+// LA assignment (BS to Robot over runicast)
+typedef struct {
+    int robot_id;
+    int la_id;
+    coord_t la_center; // Center of the assigned LA
+} la_assignment_msg_t;
+
 // Mp (Robot broadcast for Topology Discovery)
 typedef struct {
     int robot_id;
@@ -143,12 +173,29 @@ typedef struct {
     int sensor_status; // 0: idle, 1: active
 } sensor_m_msg_t;
 
-// Robot to Sensor Activation Message (for moving/activating sensors)
+// Grid command (Robot broadcast to sensors): every collect/activate of one grid in a single frame
+#define SENSOR_ACTION_COLLECT 0 // Taken into the robot's stock: idle, no longer answers Mp
+#define SENSOR_ACTION_ACTIVATE 1 // Placed from stock (cases 1 and 2) or moved (case 3) to the grid center and activated
 typedef struct {
     int sensor_id;
-    int activate_status; // 0: idle, 1: activate
-    coord_t new_coord; // If sensor is being "moved" (only in case 3 conceptually)
-} robot_to_sensor_msg_t;
+    int action; // SENSOR_ACTION_*
+} grid_command_entry_t;
+
+typedef struct {
+    int robot_id;
+    int seqno; // Repeated when the robot rebroadcasts the frame
+    coord_t grid_center;
+    int num_entries;
+    grid_command_entry_t entries[GRID_COMMAND_MAX_ENTRIES]; // Only num_entries are sent
+} grid_command_msg_t;
+#define GRID_COMMAND_LEN(n) (offsetof(grid_command_msg_t, entries) + (n) * sizeof(grid_command_entry_t))
+
+// Grid command ack (Sensor to Robot): bit i set if the sensor applied entry i
+typedef struct {
+    int robot_id;
+    int seqno;
+    unsigned char applied[GRID_COMMAND_ACK_BYTES];
+} grid_command_ack_msg_t;
 
 // --- Energy Tracking Structures ---
 typedef struct {
@@ -171,24 +218,46 @@ energy_stats_t node_energy_stats[MAX_TOTAL_NODES + 1];
 la_db_record_t la_db[NO_LA];
 robot_db_record_t robot_db[NUM_ROBOTS];
 int total_covered_grids_global_bs = 0; // For Per_AC calculation on BS
-int robots_finished_current_phase = 0; // Counter for BS to know when to proceed
+int robot_reports_bs = 0; // Robot_pM messages received; rounds are derived from it for reporting only
+int assignment_in_flight_idx = -1; // Robot_DB index of the assignment runicast is carrying
+int assignment_in_flight_la_id = -1;
 #endif
 
 // Robot related global variables
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_ROBOT
 grid_db_record_t robot_grid_db[MAX_GRIDS_PER_LA];
 robot_sensor_db_record_t robot_sensor_db[MAX_SENSORS_PER_LA]; // Sensors *seen* by this robot
+int robot_sensor_slot_of[MAX_TOTAL_NODES + 1]; // Sensor node id -> robot_sensor_db slot, -1 if not held
+int robot_sensor_free_next[MAX_SENSORS_PER_LA]; // Free-slot stack links, -1 terminates
+int robot_sensor_free_head; // First free slot, -1 if the DB is full
 int robot_stock_rs;
+int robot_stock_ids[ROBOT_STOCK_CAPACITY]; // Collected sensor nodes in stock, last collected on top
+int robot_num_stock_ids; // Stock beyond these is not backed by a sensor node
 int robot_current_la_id;
 int robot_no_p; // Permissible moves
 coord_t robot_current_pos; // Robot's current simulated position
+la_assignment_msg_t robot_assignment; // Latest LA assignment received from the BS
+int robot_assignment_pending = 0; // Set by the runicast callback, consumed by the local phase loop
+int robot_last_assignment_seqno = -1; // Runicast seqno of the last accepted assignment
+robot_pm_msg_t robot_report; // Latest Robot_pM, resent until acked or superseded by an assignment
+int robot_report_pending = 0;
+int robot_reports_sent = 0; // Robot_pM messages queued so far
+int robot_report_in_flight = -1; // robot_reports_sent value of the report runicast is carrying
 double robot_distance_moved_total = 0.0; // Cumulative distance for mobility energy
+grid_command_msg_t robot_grid_command; // Command frame of the current grid
+unsigned char robot_grid_command_acked[GRID_COMMAND_ACK_BYTES]; // Entries acked so far (OR of all acks)
+int robot_grid_command_sends; // Broadcasts of the current frame
 #endif
 
 // Sensor related global variables
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_SENSOR
 coord_t my_sensor_pos;
 int is_sensor_active = 0; // 0: idle, 1: active (i.e., contributing to coverage)
+int is_sensor_collected = 0; // 1 while in a robot's stock: idle and not answering Mp
+grid_command_ack_msg_t sensor_last_ack; // Ack of the last grid command seen, resent on a rebroadcast
+int sensor_last_ack_valid = 0; // sensor_last_ack holds entries for this sensor
+unsigned long sensor_energy_start; // clock_seconds() when the sensor started
+unsigned long sensor_energy_periods = 0; // One-second energy periods charged so far
 #endif
 
 // --- Cooja Processes ---
@@ -209,8 +278,9 @@ void update_baseline_energy(int id, double power_W, clock_time_t duration_ticks)
     node_energy_stats[id].total_baseline_energy += power_W * ((double)duration_ticks / CLOCK_SECOND);
 }
 
-void update_sensing_energy(int id, double sensing_range) {
-    node_energy_stats[id].total_sensing_energy += MU_SENSING * sensing_range * sensing_range;
+// One sensing round per second of activity; `periods` rounds at once
+void update_sensing_energy(int id, double sensing_range, unsigned long periods) {
+    node_energy_stats[id].total_sensing_energy += periods * MU_SENSING * sensing_range * sensing_range;
 }
 
 void update_processing_energy(int id, double power_W, clock_time_t duration_ticks) {
@@ -242,24 +312,104 @@ static struct unicast_conn unicast_conn_general;
 static struct broadcast_conn broadcast_conn_general;
 
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_BS
-// BS unicast receive callback (from robots)
-static void unicast_recv_bs(struct unicast_conn *c, const rimeaddr_t *from) {
+// Find an uncovered LA (num_covered_grids == 0) that no other robot is working on
+static int find_uncovered_la_for_robot(int robot_idx) {
+    for (int i = 0; i < NO_LA; i++) {
+        if (la_db[i].num_covered_grids != 0) continue;
+
+        int held_by_other = 0;
+        for (int r = 0; r < NUM_ROBOTS; r++) {
+            if (r != robot_idx && robot_db[r].assigned_la_id == la_db[i].la_id) {
+                held_by_other = 1;
+                break;
+            }
+        }
+        if (!held_by_other) return i;
+    }
+    return -1;
+}
+
+static struct runicast_conn runicast_conn_assignment;
+static struct ctimer assignment_retry_timer;
+
+// Send the first unacknowledged LA assignment; runicast carries one packet at a time,
+// so the others go out from the sent/timedout callbacks
+static void send_next_la_assignment(void *ptr) {
+    if (runicast_is_transmitting(&runicast_conn_assignment)) return;
+
+    for (int i = 0; i < NUM_ROBOTS; i++) {
+        if (!robot_db[i].assignment_pending) continue;
+
+        la_assignment_msg_t msg;
+        msg.robot_id = robot_db[i].robot_id;
+        msg.la_id = robot_db[i].assigned_la_id;
+        msg.la_center = la_db[msg.la_id].center_coord;
+
+        rimeaddr_t robot_addr;
+        robot_addr.u8[0] = msg.robot_id;
+        robot_addr.u8[1] = 0;
+
+        assignment_in_flight_idx = i;
+        assignment_in_flight_la_id = msg.la_id;
+        packetbuf_copyfrom(&msg, sizeof(msg));
+        runicast_send(&runicast_conn_assignment, &robot_addr, ASSIGNMENT_MAX_RETRANSMISSIONS);
+        update_transmit_energy(node_id, P_TRANSMIT_BASE, sizeof(msg));
+        printf("BS (%d): Sent LA %d assignment to Robot %d.\n", node_id, msg.la_id, msg.robot_id);
+        return;
+    }
+}
+
+// Queue robot_db[robot_idx]'s current assignment for delivery
+static void send_la_assignment(int robot_idx) {
+    robot_db[robot_idx].assignment_pending = 1;
+    send_next_la_assignment(NULL);
+}
+
+static void sent_assignment_bs(struct runicast_conn *c, const rimeaddr_t *to, uint8_t retransmissions) {
+    int i = assignment_in_flight_idx;
+    // A newer assignment queued while this one was in flight is still pending
+    if (i != -1 && robot_db[i].assigned_la_id == assignment_in_flight_la_id) {
+        robot_db[i].assignment_pending = 0;
+        printf("BS (%d): Robot %d acked LA %d assignment (%d retransmissions).\n", node_id, to->u8[0], assignment_in_flight_la_id, retransmissions);
+    }
+    assignment_in_flight_idx = -1;
+    send_next_la_assignment(NULL);
+}
+
+static void timedout_assignment_bs(struct runicast_conn *c, const rimeaddr_t *to, uint8_t retransmissions) {
+    printf("BS (%d): LA %d assignment to Robot %d not acked after %d retransmissions. Retrying.\n", node_id, assignment_in_flight_la_id, to->u8[0], retransmissions);
+    assignment_in_flight_idx = -1;
+    ctimer_set(&assignment_retry_timer, ASSIGNMENT_RETRY_INTERVAL, send_next_la_assignment, NULL);
+}
+static const struct runicast_callbacks runicast_callbacks_bs = {NULL, sent_assignment_bs, timedout_assignment_bs};
+
+// BS runicast receive callback (Robot_pM from robots; runicast acks it)
+static struct runicast_conn runicast_conn_report;
+static void robot_pm_recv_bs(struct runicast_conn *c, const rimeaddr_t *from, uint8_t seqno) {
     robot_pm_msg_t msg;
     if (packetbuf_datalen() == sizeof(robot_pm_msg_t)) {
         memcpy(&msg, packetbuf_dataptr(), packetbuf_datalen());
 
-        printf("BS (%d): Received Robot_pM from Robot %d (covered %d grids).\n", node_id, msg.robot_id, msg.covered_grids_in_la);
         update_receive_energy(node_id, P_RECEIVE_BASE, packetbuf_datalen());
 
         // Find assigned LA for this robot and update LA_DB
+        int robot_idx = -1;
         int assigned_la_idx = -1;
         for (int i = 0; i < NUM_ROBOTS; i++) {
             if (robot_db[i].robot_id == msg.robot_id) {
+                robot_idx = i;
                 assigned_la_idx = robot_db[i].assigned_la_id;
                 break;
             }
         }
 
+        // A retransmission after a lost ack repeats the seqno; handling it again would skip an LA
+        if (robot_idx != -1 && seqno == robot_db[robot_idx].last_report_seqno) {
+            return;
+        }
+        if (robot_idx != -1) robot_db[robot_idx].last_report_seqno = seqno;
+        printf("BS (%d): Received Robot_pM from Robot %d (covered %d grids).\n", node_id, msg.robot_id, msg.covered_grids_in_la);
+
         if (assigned_la_idx != -1 && la_db[assigned_la_idx].num_covered_grids == 0) { // Only update if LA was not yet counted
             la_db[assigned_la_idx].num_covered_grids = msg.covered_grids_in_la;
             total_covered_grids_global_bs += msg.covered_grids_in_la;
@@ -267,19 +417,85 @@ static void unicast_recv_bs(struct unicast_conn *c, const rimeaddr_t *from) {
             update_processing_energy(node_id, P_PROCESSING_BASE, CLOCK_SECOND / 10); // Small processing cost
         }
 
-        robots_finished_current_phase++;
-        if (robots_finished_current_phase == NUM_ROBOTS) {
-            printf("BS (%d): All robots reported. Triggering next assignment phase.\n", node_id);
-            process_post(&main_node_process, PROCESS_EVENT_CONTINUE, NULL); // Signal BS process to continue
+        // Rounds (one report per robot) are only counted for reporting; nobody waits on them
+        robot_reports_bs++;
+        if (robot_reports_bs % NUM_ROBOTS == 0) {
+            update_baseline_energy(node_id, P_BASELINE_BASE, CLOCK_SECOND); // Baseline energy per global phase round
+            printf("BS (%d): Global phase round %d complete (%d reports).\n", node_id, robot_reports_bs / NUM_ROBOTS, robot_reports_bs);
+        }
+
+        if (robot_idx == -1) {
+            printf("BS (%d): Robot_pM from unknown Robot %d ignored.\n", node_id, msg.robot_id);
+            return;
+        }
+
+        // Asynchronous global phase: hand this robot its next LA right away instead of
+        // waiting for the slowest robot, so makespan follows total work
+        int next_la_idx = find_uncovered_la_for_robot(robot_idx);
+        if (next_la_idx != -1) {
+            robot_db[robot_idx].assigned_la_id = la_db[next_la_idx].la_id;
+            printf("BS (%d): Re-assigned Robot %d to LA %d.\n", node_id, msg.robot_id, la_db[next_la_idx].la_id);
+            update_processing_energy(node_id, P_PROCESSING_BASE, CLOCK_SECOND / 10);
+            send_la_assignment(robot_idx);
+        } else {
+            robot_db[robot_idx].assigned_la_id = -1;
+            printf("BS (%d): No more uncovered LAs to assign to Robot %d.\n", node_id, msg.robot_id);
+
+            int robots_busy = 0;
+            for (int i = 0; i < NUM_ROBOTS; i++) {
+                if (robot_db[i].assigned_la_id != -1) robots_busy++;
+            }
+            if (robots_busy == 0) {
+                process_post(&main_node_process, PROCESS_EVENT_CONTINUE, NULL); // Signal BS process to finish
+            }
         }
     } else {
         printf("BS (%d): Received malformed Robot_pM from %d.\n", node_id, from->u8[0]);
     }
 }
-static const struct unicast_callbacks unicast_callbacks_bs = {unicast_recv_bs};
+static const struct runicast_callbacks runicast_callbacks_report_bs = {robot_pm_recv_bs, NULL, NULL};
 #endif // NODE_TYPE_BS
 
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_ROBOT
+// --- Robot Sensor_DB: slots indexed by sensor node id, free slots kept on a stack ---
+
+// Empty the DB; every slot goes back on the free stack
+static void robot_sensor_db_reset(void) {
+    memset(robot_sensor_db, 0, sizeof(robot_sensor_db));
+    for (int id = 0; id <= MAX_TOTAL_NODES; id++) {
+        robot_sensor_slot_of[id] = -1;
+    }
+    for (int i = 0; i < MAX_SENSORS_PER_LA; i++) {
+        robot_sensor_free_next[i] = (i + 1 < MAX_SENSORS_PER_LA) ? i + 1 : -1;
+    }
+    robot_sensor_free_head = 0;
+}
+
+// Add a sensor or update its record; returns its slot, or -1 if the id is invalid or the DB is full
+static int robot_sensor_db_upsert(int sensor_id, coord_t coord, int status) {
+    if (sensor_id <= 0 || sensor_id > MAX_TOTAL_NODES) return -1; // node_id 0 is invalid
+
+    int slot = robot_sensor_slot_of[sensor_id];
+    if (slot == -1) {
+        if (robot_sensor_free_head == -1) return -1;
+        slot = robot_sensor_free_head;
+        robot_sensor_free_head = robot_sensor_free_next[slot];
+        robot_sensor_slot_of[sensor_id] = slot;
+        robot_sensor_db[slot].sensor_node_id = sensor_id;
+    }
+    robot_sensor_db[slot].coord = coord;
+    robot_sensor_db[slot].sensor_status = status;
+    return slot;
+}
+
+// Drop the sensor in `slot` (e.g. collected into stock) and free the slot
+static void robot_sensor_db_release(int slot) {
+    robot_sensor_slot_of[robot_sensor_db[slot].sensor_node_id] = -1;
+    robot_sensor_db[slot].sensor_node_id = 0; // Mark slot as empty
+    robot_sensor_free_next[slot] = robot_sensor_free_head;
+    robot_sensor_free_head = slot;
+}
+
 // Robot unicast receive callback (from sensors)
 static void unicast_recv_robot(struct unicast_conn *c, const rimeaddr_t *from) {
     sensor_m_msg_t msg;
@@ -289,26 +505,8 @@ static void unicast_recv_robot(struct unicast_conn *c, const rimeaddr_t *from) {
         // printf("Robot %d: Rcvd Sensor_M from S%d @(%d,%d), status %d.\n", node_id, msg.sensor_id, msg.sensor_coord.x, msg.sensor_coord.y, msg.sensor_status);
         update_receive_energy(node_id, P_RECEIVE_ROBOT, packetbuf_datalen());
 
-        // Add/update sensor in robot's Sensor_DB
-        int found = 0;
-        for (int i = 0; i < MAX_SENSORS_PER_LA; i++) {
-            if (robot_sensor_db[i].sensor_node_id == msg.sensor_id) {
-                robot_sensor_db[i].coord = msg.sensor_coord;
-                robot_sensor_db[i].sensor_status = msg.sensor_status;
-                found = 1;
-                break;
-            }
-        }
-        if (!found) { // Add new sensor if space available
-            for (int i = 0; i < MAX_SENSORS_PER_LA; i++) {
-                if (robot_sensor_db[i].sensor_node_id == 0) { // Empty slot (assuming node_id 0 is invalid)
-                    robot_sensor_db[i].sensor_node_id = msg.sensor_id;
-                    robot_sensor_db[i].coord = msg.sensor_coord;
-                    robot_sensor_db[i].sensor_status = msg.sensor_status;
-                    break;
-                }
-            }
-        }
+        // Add/update sensor in robot's Sensor_DB (new sensors are dropped once it is full)
+        robot_sensor_db_upsert(msg.sensor_id, msg.sensor_coord, msg.sensor_status);
         update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 20); // Small processing cost
     } else {
          printf("Robot %d: Received malformed Sensor_M from %d.\n", node_id, from->u8[0]);
@@ -317,6 +515,135 @@ static void unicast_recv_robot(struct unicast_conn *c, const rimeaddr_t *from) {
 
 static const struct unicast_callbacks unicast_callbacks_robot = {unicast_recv_robot};
 
+// Grid commands go out on their own broadcast channel; sensors ack them on a separate port
+static struct broadcast_conn broadcast_conn_command;
+static const struct broadcast_callbacks broadcast_callbacks_robot_command = {NULL};
+
+// Robot unicast receive callback (grid command acks from sensors)
+static struct unicast_conn unicast_conn_ack;
+static void unicast_recv_robot_ack(struct unicast_conn *c, const rimeaddr_t *from) {
+    grid_command_ack_msg_t ack;
+    if (packetbuf_datalen() == sizeof(grid_command_ack_msg_t)) {
+        memcpy(&ack, packetbuf_dataptr(), packetbuf_datalen());
+
+        update_receive_energy(node_id, P_RECEIVE_ROBOT, packetbuf_datalen());
+
+        if (ack.robot_id != node_id || ack.seqno != robot_grid_command.seqno) return; // Late ack of an earlier grid
+        for (int i = 0; i < GRID_COMMAND_ACK_BYTES; i++) {
+            robot_grid_command_acked[i] |= ack.applied[i];
+        }
+    } else {
+        printf("Robot %d: Received malformed grid command ack from %d.\n", node_id, from->u8[0]);
+    }
+}
+static const struct unicast_callbacks unicast_callbacks_robot_ack = {unicast_recv_robot_ack};
+
+// Entries of the current grid command no ack has covered yet
+static int grid_command_unacked(void) {
+    int missing = 0;
+    for (int i = 0; i < robot_grid_command.num_entries; i++) {
+        if (!(robot_grid_command_acked[i / 8] & (1 << (i % 8)))) missing++;
+    }
+    return missing;
+}
+
+// Add a collect/activate entry to the current grid command
+static void grid_command_add(int sensor_id, int action) {
+    if (robot_grid_command.num_entries >= GRID_COMMAND_MAX_ENTRIES) {
+        printf("Robot %d: Grid command full, sensor %d not told.\n", node_id, sensor_id);
+        return;
+    }
+    robot_grid_command.entries[robot_grid_command.num_entries].sensor_id = sensor_id;
+    robot_grid_command.entries[robot_grid_command.num_entries].action = action;
+    robot_grid_command.num_entries++;
+}
+
+// Place a sensor from stock at the grid center; the most recently collected
+// sensor node is the one placed, if the stock holds any
+static void stock_deploy(void) {
+    robot_stock_rs--;
+    if (robot_num_stock_ids > 0) {
+        grid_command_add(robot_stock_ids[--robot_num_stock_ids], SENSOR_ACTION_ACTIVATE);
+    }
+}
+
+// Take a sensor from the grid into stock and tell it (in the grid command)
+static void stock_collect(int sensor_id) {
+    robot_stock_rs++;
+    if (robot_num_stock_ids < ROBOT_STOCK_CAPACITY) {
+        robot_stock_ids[robot_num_stock_ids++] = sensor_id;
+    }
+    grid_command_add(sensor_id, SENSOR_ACTION_COLLECT);
+}
+
+// Robot_pM goes to the BS over runicast, separate from the channel sensors reply on
+static struct runicast_conn runicast_conn_report;
+static struct ctimer report_retry_timer;
+
+// Send the pending Robot_pM; runicast carries one packet at a time, so a report queued
+// while an older one is in flight goes out from the sent callback
+static void send_robot_report(void *ptr) {
+    if (!robot_report_pending || runicast_is_transmitting(&runicast_conn_report)) return;
+
+    rimeaddr_t bs_addr;
+    bs_addr.u8[0] = BS_NODE_ID;
+    bs_addr.u8[1] = 0;
+
+    robot_report_in_flight = robot_reports_sent;
+    packetbuf_copyfrom(&robot_report, sizeof(robot_report));
+    runicast_send(&runicast_conn_report, &bs_addr, REPORT_MAX_RETRANSMISSIONS);
+    update_transmit_energy(node_id, P_TRANSMIT_ROBOT, sizeof(robot_report));
+    printf("Robot %d: Sent Robot_pM to BS.\n", node_id);
+}
+
+static void sent_report_robot(struct runicast_conn *c, const rimeaddr_t *to, uint8_t retransmissions) {
+    // A newer report queued while this one was in flight is still pending
+    if (robot_report_in_flight == robot_reports_sent) {
+        robot_report_pending = 0;
+        printf("Robot %d: BS acked Robot_pM (%d retransmissions).\n", node_id, retransmissions);
+    }
+    robot_report_in_flight = -1;
+    send_robot_report(NULL);
+}
+
+static void timedout_report_robot(struct runicast_conn *c, const rimeaddr_t *to, uint8_t retransmissions) {
+    robot_report_in_flight = -1;
+    if (!robot_report_pending) return; // The next assignment already arrived
+    printf("Robot %d: Robot_pM not acked after %d retransmissions. Retrying.\n", node_id, retransmissions);
+    ctimer_set(&report_retry_timer, REPORT_RETRY_INTERVAL, send_robot_report, NULL);
+}
+static const struct runicast_callbacks runicast_callbacks_report_robot = {NULL, sent_report_robot, timedout_report_robot};
+
+// Robot runicast receive callback (LA assignment from the BS; runicast acks it)
+static struct runicast_conn runicast_conn_assignment;
+static void la_assignment_recv_robot(struct runicast_conn *c, const rimeaddr_t *from, uint8_t seqno) {
+    la_assignment_msg_t msg;
+    if (packetbuf_datalen() == sizeof(la_assignment_msg_t)) {
+        memcpy(&msg, packetbuf_dataptr(), packetbuf_datalen());
+
+        update_receive_energy(node_id, P_RECEIVE_ROBOT, packetbuf_datalen());
+
+        // A retransmission after a lost ack repeats the seqno and the LA
+        if (msg.robot_id != node_id ||
+            (seqno == robot_last_assignment_seqno && msg.la_id == robot_assignment.la_id)) {
+            return;
+        }
+        robot_last_assignment_seqno = seqno;
+        robot_assignment = msg;
+        // The BS only assigns after handling our report, so a lost ack needs no more retries
+        if (robot_report_pending) {
+            robot_report_pending = 0;
+            ctimer_stop(&report_retry_timer);
+        }
+        robot_assignment_pending = 1;
+        printf("Robot %d: Received assignment to LA %d at (%d,%d).\n", node_id, msg.la_id, msg.la_center.x, msg.la_center.y);
+        process_post(&main_node_process, PROCESS_EVENT_CONTINUE, NULL); // Wake the local phase loop
+    } else {
+        printf("Robot %d: Received malformed LA assignment from %d.\n", node_id, from->u8[0]);
+    }
+}
+static const struct runicast_callbacks runicast_callbacks_robot = {la_assignment_recv_robot, NULL, NULL};
+
 // Robot broadcast receive callback (not used for robot's own logic, but required by Rime)
 static void broadcast_recv_robot(struct broadcast_conn *c, const rimeaddr_t *from) {
     // Robots generally ignore broadcasts from other robots for this simulation logic
@@ -325,6 +652,24 @@ static const struct broadcast_callbacks broadcast_callbacks_robot = {broadcast_r
 #endif // NODE_TYPE_ROBOT
 
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_SENSOR
+// Charge the one-second periods that have started since the last settle, at the current state.
+// The sensor does not wake up to do this every second: it is settled before every state change
+// and every report, which yields the same totals a 1 Hz accounting loop would.
+static void sensor_settle_energy(void) {
+    unsigned long due = clock_seconds() - sensor_energy_start + 1; // Period 0 starts at boot
+    if (due <= sensor_energy_periods) return;
+    unsigned long periods = due - sensor_energy_periods;
+    sensor_energy_periods = due;
+
+    update_baseline_energy(node_id, P_BASELINE_SENSOR * periods, CLOCK_SECOND);
+    if (is_sensor_active) {
+        update_sensing_energy(node_id, SENSOR_SENSING_RANGE, periods);
+        update_processing_energy(node_id, P_PROCESSING_SENSOR * periods, CLOCK_SECOND / 10);
+    } else {
+        update_idle_radio_energy(node_id, P_IDLE_RADIO_SENSOR * periods, CLOCK_SECOND / 2); // Radio is always on for listening
+    }
+}
+
 // Sensor broadcast receive callback (from robot Mp)
 static void broadcast_recv_sensor(struct broadcast_conn *c, const rimeaddr_t *from) {
     mp_msg_t msg;
@@ -333,8 +678,8 @@ static void broadcast_recv_sensor(struct broadcast_conn *c, const rimeaddr_t *fr
 
         update_receive_energy(node_id, P_RECEIVE_SENSOR, packetbuf_datalen());
 
-        // Check if robot is within perception range
-        if (calculate_distance(my_sensor_pos, msg.robot_coord) <= ROBOT_PERCEPTION_RANGE) {
+        // Check if robot is within perception range (a collected sensor is in a robot's stock, not the field)
+        if (!is_sensor_collected && calculate_distance(my_sensor_pos, msg.robot_coord) <= ROBOT_PERCEPTION_RANGE) {
             // printf("S%d: Rcvd Mp from R%d. Robot @(%d,%d). My pos (%d,%d). In range.\n",
             //        node_id, msg.robot_id, msg.robot_coord.x, msg.robot_coord.y, my_sensor_pos.x, my_sensor_pos.y);
 
@@ -358,30 +703,68 @@ static void broadcast_recv_sensor(struct broadcast_conn *c, const rimeaddr_t *fr
 }
 static const struct broadcast_callbacks broadcast_callbacks_sensor = {broadcast_recv_sensor};
 
-// Sensor unicast receive callback (from robot for activation/deactivation/move)
-static void unicast_recv_sensor_activation(struct unicast_conn *c, const rimeaddr_t *from) {
-    robot_to_sensor_msg_t msg;
-    if (packetbuf_datalen() == sizeof(robot_to_sensor_msg_t)) {
-        memcpy(&msg, packetbuf_dataptr(), packetbuf_datalen());
-
-        update_receive_energy(node_id, P_RECEIVE_SENSOR, packetbuf_datalen());
+// Sensor_M goes out on the channel robots listen on; sensors receive nothing by unicast
+static const struct unicast_callbacks unicast_callbacks_sensor = {NULL};
+
+// Grid commands arrive on their own broadcast channel; acks go to the robot on their own port
+static struct broadcast_conn broadcast_conn_command;
+static struct unicast_conn unicast_conn_ack;
+static const struct unicast_callbacks unicast_callbacks_sensor_ack = {NULL};
+
+// Sensor broadcast receive callback (grid command from a robot: collect or activate/move)
+static void broadcast_recv_sensor_command(struct broadcast_conn *c, const rimeaddr_t *from) {
+    static grid_command_msg_t msg;
+    int len = packetbuf_datalen();
+    if (len <= (int)GRID_COMMAND_LEN(0) || len > (int)sizeof(grid_command_msg_t)) {
+        printf("S%d: Rcvd malformed grid command from %d.\n", node_id, from->u8[0]);
+        return;
+    }
+    memcpy(&msg, packetbuf_dataptr(), len);
+    if (msg.num_entries > GRID_COMMAND_MAX_ENTRIES || len != (int)GRID_COMMAND_LEN(msg.num_entries)) {
+        printf("S%d: Rcvd malformed grid command from %d.\n", node_id, from->u8[0]);
+        return;
+    }
 
-        if (msg.sensor_id == node_id) { // Message is for me
-            is_sensor_active = msg.activate_status;
-            // If the sensor is conceptually "moved" (Case 3), update its position
-            if (is_sensor_active) { // Only move if activating it for coverage
-                my_sensor_pos = msg.new_coord;
+    update_receive_energy(node_id, P_RECEIVE_SENSOR, len);
+
+    // Apply my entries once; a rebroadcast (same robot and seqno) only gets the ack again
+    if (msg.robot_id != sensor_last_ack.robot_id || msg.seqno != sensor_last_ack.seqno) {
+        sensor_settle_energy(); // Charge the time spent in the old state before changing it
+        sensor_last_ack.robot_id = msg.robot_id;
+        sensor_last_ack.seqno = msg.seqno;
+        memset(sensor_last_ack.applied, 0, sizeof(sensor_last_ack.applied));
+        sensor_last_ack_valid = 0;
+
+        for (int i = 0; i < msg.num_entries; i++) {
+            if (msg.entries[i].sensor_id != node_id) continue; // Entry for another sensor
+            if (msg.entries[i].action == SENSOR_ACTION_ACTIVATE) {
+                // Conceptually moved to the grid center (case 3) and activated for coverage
+                is_sensor_active = 1;
+                is_sensor_collected = 0;
+                my_sensor_pos = msg.grid_center;
                 printf("S%d: Activated and moved to (%d,%d).\n", node_id, my_sensor_pos.x, my_sensor_pos.y);
             } else {
-                printf("S%d: Deactivated.\n", node_id);
+                is_sensor_active = 0;
+                is_sensor_collected = 1;
+                printf("S%d: Collected into robot %d's stock.\n", node_id, msg.robot_id);
             }
+            sensor_last_ack.applied[i / 8] |= 1 << (i % 8);
+            sensor_last_ack_valid = 1;
             update_processing_energy(node_id, P_PROCESSING_SENSOR, CLOCK_SECOND / 20);
         }
-    } else {
-        printf("S%d: Rcvd malformed activation msg from %d.\n", node_id, from->u8[0]);
+    }
+
+    if (sensor_last_ack_valid) {
+        rimeaddr_t robot_addr;
+        robot_addr.u8[0] = msg.robot_id;
+        robot_addr.u8[1] = 0;
+
+        packetbuf_copyfrom(&sensor_last_ack, sizeof(sensor_last_ack));
+        unicast_send(&unicast_conn_ack, &robot_addr);
+        update_transmit_energy(node_id, P_TRANSMIT_SENSOR, sizeof(sensor_last_ack));
     }
 }
-static const struct unicast_callbacks unicast_callbacks_sensor = {unicast_recv_sensor_activation};
+static const struct broadcast_callbacks broadcast_callbacks_sensor_command = {broadcast_recv_sensor_command};
 #endif // NODE_TYPE_SENSOR
 
 
@@ -394,8 +777,9 @@ PROCESS_THREAD(main_node_process, ev, data) {
 
 #if defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_BS
     printf("BS (Node ID: %d): Starting...\n", node_id);
-    // Open unicast for receiving from robots
-    unicast_open(&unicast_conn_general, ROBOT_TO_BS_UNICAST_PORT, &unicast_callbacks_bs);
+    // Open runicast for receiving Robot_pM from robots and for sending them LA assignments
+    runicast_open(&runicast_conn_report, ROBOT_TO_BS_REPORT_PORT, &runicast_callbacks_report_bs);
+    runicast_open(&runicast_conn_assignment, BS_TO_ROBOT_ASSIGNMENT_PORT, &runicast_callbacks_bs);
 
     // Initialize LA_DB for the entire target area
     for (int y = 0; y < NUM_LAs_Y; y++) {
@@ -411,6 +795,9 @@ PROCESS_THREAD(main_node_process, ev, data) {
     printf("BS: LA_DB initialized with %d LAs.\n", NO_LA);
 
     // Initial Robot_DB assignment as per the problem description
+    for (int i = 0; i < NUM_ROBOTS; i++) {
+        robot_db[i].last_report_seqno = -1;
+    }
     robot_db[0].robot_id = ROBOT_NODE_ID_START;
     robot_db[0].assigned_la_id = 0; // Assign first LA to Robot 1
     printf("BS: Robot %d assigned to LA %d.\n", robot_db[0].robot_id, robot_db[0].assigned_la_id);
@@ -422,77 +809,59 @@ PROCESS_THREAD(main_node_process, ev, data) {
     }
 
     static struct etimer bs_timer;
-    etimer_set(&bs_timer, CLOCK_SECOND * 5); // Give robots time to initialize and read their assignments
+    etimer_set(&bs_timer, CLOCK_SECOND * 5); // Give robots time to initialize and open their connections
 
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&bs_timer));
 
-    // Global Phase loop - BS coordinates robot deployments
-    while (1) {
-        update_baseline_energy(node_id, P_BASELINE_BASE, CLOCK_SECOND); // Baseline energy per global phase cycle
-        robots_finished_current_phase = 0; // Reset counter for this iteration
-
-        // Wait for all robots to report back after completing their local phase
-        printf("BS (%d): Waiting for all %d robots to complete their local phase...\n", node_id, NUM_ROBOTS);
-        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE && robots_finished_current_phase == NUM_ROBOTS);
-
-        int assigned_new_la_count = 0;
-        for (int p_idx = 0; p_idx < NUM_ROBOTS; p_idx++) {
-            int robot_id = robot_db[p_idx].robot_id;
-            int found_new_la = 0;
-            // Search for an uncovered LA (num_covered_grids == 0)
-            for (int i = 0; i < NO_LA; i++) {
-                if (la_db[i].num_covered_grids == 0) {
-                    robot_db[p_idx].assigned_la_id = la_db[i].la_id;
-                    found_new_la = 1;
-                    assigned_new_la_count++;
-                    printf("BS (%d): Re-assigned Robot %d to LA %d.\n", node_id, robot_id, la_db[i].la_id);
-                    update_processing_energy(node_id, P_PROCESSING_BASE, CLOCK_SECOND / 10);
-                    break; // Assign this LA and move to next robot
-                }
-            }
-            if (!found_new_la) {
-                printf("BS (%d): No more uncovered LAs to assign to Robot %d.\n", node_id, robot_id);
-            }
-        }
+    // Deliver the initial assignments (first and last LA) over the air
+    for (int i = 0; i < NUM_ROBOTS && i < 2; i++) {
+        send_la_assignment(i);
+    }
 
-        if (assigned_new_la_count == 0) { // All LAs are covered or no new ones found for any robot
-            printf("\nBS (%d): All LAs covered or no new assignments possible. Simulation complete.\n", node_id);
-            // Calculate and print final area coverage
-            double per_ac = (double)total_covered_grids_global_bs / (NO_LA * MAX_GRIDS_PER_LA) * 100.0;
-            printf("BS (%d): Final Percentage of Area Coverage (Per_AC): %.2f%%\n", node_id, per_ac);
-            
-            // Print total energy consumption for all nodes
-            printf("\n--- TOTAL ENERGY CONSUMPTION REPORT ---\n");
-            double total_sys_energy = 0;
-            for(int i = 1; i <= MAX_TOTAL_NODES; i++) { // Iterate through all possible node IDs
-                double node_total_energy =
-                    node_energy_stats[i].total_baseline_energy +
-                    node_energy_stats[i].total_sensing_energy +
-                    node_energy_stats[i].total_processing_energy +
-                    node_energy_stats[i].total_transmit_energy +
-                    node_energy_stats[i].total_receive_energy +
-                    node_energy_stats[i].total_mobility_energy +
-                    node_energy_stats[i].total_idle_radio_energy;
-
-                total_sys_energy += node_total_energy;
-
-                if (i == BS_NODE_ID) printf("  BS (Node %d) Energy: %.4f J\n", i, node_total_energy);
-                else if (i >= ROBOT_NODE_ID_START && i < SENSOR_NODE_ID_START) printf("  Robot (Node %d) Energy: %.4f J\n", i, node_total_energy);
-                else if (i >= SENSOR_NODE_ID_START && i <= MAX_TOTAL_NODES) printf("  Sensor (Node %d) Energy: %.4f J\n", i, node_total_energy);
-            }
-            printf("  TOTAL SYSTEM ENERGY CONSUMPTION: %.4f J\n", total_sys_energy);
-            printf("--- END OF REPORT ---\n");
-            break; // End simulation for BS
-        }
+    // Global Phase - runs asynchronously in robot_pm_recv_bs: every Robot_pM immediately
+    // assigns that robot its next LA. Wait here until no robot has an LA left.
+    printf("BS (%d): Global phase running; each robot is re-assigned as soon as it reports.\n", node_id);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
+
+    printf("\nBS (%d): All LAs covered or no new assignments possible. Simulation complete.\n", node_id);
+    // Calculate and print final area coverage
+    double per_ac = (double)total_covered_grids_global_bs / (NO_LA * MAX_GRIDS_PER_LA) * 100.0;
+    printf("BS (%d): Final Percentage of Area Coverage (Per_AC): %.2f%%\n", node_id, per_ac);
+    
+    // Print total energy consumption for all nodes
+    printf("\n--- TOTAL ENERGY CONSUMPTION REPORT ---\n");
+    double total_sys_energy = 0;
+    for(int i = 1; i <= MAX_TOTAL_NODES; i++) { // Iterate through all possible node IDs
+        double node_total_energy =
+            node_energy_stats[i].total_baseline_energy +
+            node_energy_stats[i].total_sensing_energy +
+            node_energy_stats[i].total_processing_energy +
+            node_energy_stats[i].total_transmit_energy +
+            node_energy_stats[i].total_receive_energy +
+            node_energy_stats[i].total_mobility_energy +
+            node_energy_stats[i].total_idle_radio_energy;
+
+        total_sys_energy += node_total_energy;
+
+        if (i == BS_NODE_ID) printf("  BS (Node %d) Energy: %.4f J\n", i, node_total_energy);
+        else if (i >= ROBOT_NODE_ID_START && i < SENSOR_NODE_ID_START) printf("  Robot (Node %d) Energy: %.4f J\n", i, node_total_energy);
+        else if (i >= SENSOR_NODE_ID_START && i <= MAX_TOTAL_NODES) printf("  Sensor (Node %d) Energy: %.4f J\n", i, node_total_energy);
     }
+    printf("  TOTAL SYSTEM ENERGY CONSUMPTION: %.4f J\n", total_sys_energy);
+    printf("--- END OF REPORT ---\n");
 
 #elif defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_ROBOT
     printf("Robot (Node ID: %d): Starting...\n", node_id);
-    // Open Rime connections for broadcast (Mp) and unicast (Sensor_M from sensors, Robot_pM to BS)
+    // Open Rime connections for broadcast (Mp), unicast (Sensor_M from sensors) and runicast (Robot_pM to BS)
     broadcast_open(&broadcast_conn_general, BROADCAST_CHANNEL, &broadcast_callbacks_robot);
     unicast_open(&unicast_conn_general, SENSOR_TO_ROBOT_UNICAST_PORT, &unicast_callbacks_robot);
+    runicast_open(&runicast_conn_report, ROBOT_TO_BS_REPORT_PORT, &runicast_callbacks_report_robot);
+    runicast_open(&runicast_conn_assignment, BS_TO_ROBOT_ASSIGNMENT_PORT, &runicast_callbacks_robot);
+    broadcast_open(&broadcast_conn_command, ROBOT_TO_SENSOR_COMMAND_CHANNEL, &broadcast_callbacks_robot_command);
+    unicast_open(&unicast_conn_ack, SENSOR_TO_ROBOT_ACK_PORT, &unicast_callbacks_robot_ack);
 
-    robot_stock_rs = ROBOT_INITIAL_STOCK;
+    robot_stock_rs = ROBOT_INITIAL_STOCK; // Not backed by sensor nodes; collected sensors are tracked on top
+    robot_num_stock_ids = 0;
     robot_distance_moved_total = 0.0; // Reset cumulative distance
 
     static struct etimer robot_timer;
@@ -506,30 +875,21 @@ PROCESS_THREAD(main_node_process, ev, data) {
     while (1) {
         update_baseline_energy(node_id, P_BASELINE_ROBOT, CLOCK_SECOND);
 
-        // Fetch current LA assignment from "BS_DB" (simulated shared memory / lookup)
-        robot_current_la_id = -1;
-        for (int i = 0; i < NUM_ROBOTS; i++) {
-            if (robot_db[i].robot_id == node_id) {
-                robot_current_la_id = robot_db[i].assigned_la_id;
-                break;
-            }
-        }
-
-        // If no LA is assigned or the current LA is already processed, wait
-        if (robot_current_la_id == -1 || la_db[robot_current_la_id].num_covered_grids != 0) {
-            printf("Robot %d: No new LA assignment or current LA %d already processed. Waiting 5s.\n", node_id, robot_current_la_id);
-            etimer_set(&robot_timer, CLOCK_SECOND * 5);
-            PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&robot_timer));
-            continue; // Re-check assignment
+        // Sleep until the BS assigns an LA (la_assignment_recv_robot sets the flag and posts an event)
+        if (!robot_assignment_pending) {
+            printf("Robot %d: Waiting for an LA assignment from the BS.\n", node_id);
         }
+        PROCESS_WAIT_UNTIL(robot_assignment_pending);
+        robot_assignment_pending = 0;
+        robot_current_la_id = robot_assignment.la_id;
 
         printf("Robot %d: Starting Local Phase in LA %d.\n", node_id, robot_current_la_id);
         update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 2); // For overall local phase setup
 
         // Divide LA into grids and insert records into Grid_DB
         coord_t la_origin; // Bottom-left corner of LA
-        la_origin.x = la_db[robot_current_la_id].center_coord.x - (LA_WIDTH / 2);
-        la_origin.y = la_db[robot_current_la_id].center_coord.y - (LA_HEIGHT / 2);
+        la_origin.x = robot_assignment.la_center.x - (LA_WIDTH / 2);
+        la_origin.y = robot_assignment.la_center.y - (LA_HEIGHT / 2);
 
         int grid_count_in_la = 0;
         for (int gy = 0; gy < NUM_GRIDS_Y_PER_LA; gy++) {
@@ -544,12 +904,12 @@ PROCESS_THREAD(main_node_process, ev, data) {
         printf("Robot %d: LA %d divided into %d grids.\n", node_id, robot_current_la_id, grid_count_in_la);
 
         // Initialize Sensor_DB (sensors seen by this robot) to empty
-        memset(robot_sensor_db, 0, sizeof(robot_sensor_db));
+        robot_sensor_db_reset();
 
         // --- Topology Discovery Phase ---
         printf("Robot %d: Starting Topology Discovery Phase.\n", node_id);
         prev_pos = robot_current_pos;
-        robot_current_pos = la_db[robot_current_la_id].center_coord; // Move to center of LA
+        robot_current_pos = robot_assignment.la_center; // Move to center of LA
         update_mobility_energy(node_id, calculate_distance(prev_pos, robot_current_pos));
 
         // Broadcast message (Mp) for sensors to reply
@@ -599,26 +959,29 @@ PROCESS_THREAD(main_node_process, ev, data) {
 
             // Identify sensors physically present near this grid's center (within Rs/2)
             int sensors_physically_in_grid_count = 0;
-            int sensors_to_collect_node_ids[MAX_SENSORS_PER_LA];
+            int sensors_to_collect_slots[MAX_SENSORS_PER_LA]; // Sensor_DB slots, so collecting needs no search
             int collected_list_idx = 0;
 
             for (int i = 0; i < MAX_SENSORS_PER_LA; i++) {
                 if (robot_sensor_db[i].sensor_node_id != 0) { // If this slot in robot's DB holds a sensor
                     if (calculate_distance(robot_sensor_db[i].coord, robot_current_pos) <= SENSOR_SENSING_RANGE / 2.0) {
                         sensors_physically_in_grid_count++;
-                        sensors_to_collect_node_ids[collected_list_idx++] = robot_sensor_db[i].sensor_node_id;
+                        sensors_to_collect_slots[collected_list_idx++] = i;
                     }
                 }
             }
             update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 20); // Cost for checking sensors
 
             int grid_became_covered = 0;
-            robot_to_sensor_msg_t sensor_control_msg; // Message to activate/deactivate actual sensors
-            rimeaddr_t target_sensor_addr;
+            // Collects and the activation of this grid are batched into one command frame
+            robot_grid_command.robot_id = node_id;
+            robot_grid_command.seqno++;
+            robot_grid_command.grid_center = robot_current_pos;
+            robot_grid_command.num_entries = 0;
 
             if (robot_stock_rs > 0 && sensors_physically_in_grid_count > 0) {
                 // Case 1: Robot has sensors and grid has sensors
-                robot_stock_rs--; // Place one sensor (from stock)
+                stock_deploy(); // Place one sensor (from stock)
                 grid_became_covered = 1;
                 printf("Robot %d, Grid %d: Case 1. Placed new sensor from stock. Stock: %d.\n", node_id, target_grid_idx, robot_stock_rs);
 
@@ -626,24 +989,12 @@ PROCESS_THREAD(main_node_process, ev, data) {
                 int num_collected_this_turn = 0;
                 for (int i = 0; i < collected_list_idx; i++) {
                     if (robot_stock_rs < ROBOT_STOCK_CAPACITY) {
-                        // Find the sensor in robot_sensor_db and remove it (conceptually collected)
-                        for (int j = 0; j < MAX_SENSORS_PER_LA; j++) {
-                            if (robot_sensor_db[j].sensor_node_id == sensors_to_collect_node_ids[i]) {
-                                robot_sensor_db[j].sensor_node_id = 0; // Mark slot as empty
-                                robot_stock_rs++;
-                                num_collected_this_turn++;
-                                // Tell the actual sensor node it is idle/collected
-                                sensor_control_msg.sensor_id = sensors_to_collect_node_ids[i];
-                                sensor_control_msg.activate_status = 0; // Set to Idle
-                                sensor_control_msg.new_coord = robot_sensor_db[j].coord; // Keep its existing coordinate
-                                target_sensor_addr.u8[0] = sensor_control_msg.sensor_id; target_sensor_addr.u8[1] = 0;
-                                packetbuf_copyfrom(&sensor_control_msg, sizeof(sensor_control_msg));
-                                unicast_send(&unicast_conn_general, &target_sensor_addr);
-                                update_transmit_energy(node_id, P_TRANSMIT_ROBOT, sizeof(sensor_control_msg));
-                                update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 50); // For collecting
-                                break;
-                            }
-                        }
+                        // Remove the sensor from robot_sensor_db (conceptually collected)
+                        int j = sensors_to_collect_slots[i];
+                        num_collected_this_turn++;
+                        stock_collect(robot_sensor_db[j].sensor_node_id);
+                        robot_sensor_db_release(j);
+                        update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 50); // For collecting
                     } else {
                         break; // Stock capacity reached
                     }
@@ -652,7 +1003,7 @@ PROCESS_THREAD(main_node_process, ev, data) {
 
             } else if (robot_stock_rs > 0 && sensors_physically_in_grid_count == 0) {
                 // Case 2: Robot has sensors but grid has no sensors
-                robot_stock_rs--; // Place one sensor from stock
+                stock_deploy(); // Place one sensor from stock
                 grid_became_covered = 1;
                 printf("Robot %d, Grid %d: Case 2. Placed new sensor. Stock: %d.\n", node_id, target_grid_idx, robot_stock_rs);
             } else if (robot_stock_rs == 0 && sensors_physically_in_grid_count > 0) {
@@ -660,17 +1011,11 @@ PROCESS_THREAD(main_node_process, ev, data) {
                 grid_became_covered = 1; // Grid is covered by an existing sensor
 
                 // Find a sensor to "move" to center (conceptually activating it for coverage)
-                // We'll pick the first sensor found in `sensors_to_collect_node_ids`
-                int sensor_to_activate_id = sensors_to_collect_node_ids[0];
+                // We'll pick the first sensor found in `sensors_to_collect_slots`
+                int sensor_to_activate_id = robot_sensor_db[sensors_to_collect_slots[0]].sensor_node_id;
                 
-                // Send activation message to this sensor, effectively moving it to grid center
-                sensor_control_msg.sensor_id = sensor_to_activate_id;
-                sensor_control_msg.activate_status = 1; // Set to Active
-                sensor_control_msg.new_coord = robot_current_pos; // Tell it its new "effective" position
-                target_sensor_addr.u8[0] = sensor_control_msg.sensor_id; target_sensor_addr.u8[1] = 0;
-                packetbuf_copyfrom(&sensor_control_msg, sizeof(sensor_control_msg));
-                unicast_send(&unicast_conn_general, &target_sensor_addr);
-                update_transmit_energy(node_id, P_TRANSMIT_ROBOT, sizeof(sensor_control_msg));
+                // Activate this sensor, effectively moving it to grid center (the frame carries the center)
+                grid_command_add(sensor_to_activate_id, SENSOR_ACTION_ACTIVATE);
                 update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 20); // For identifying/moving
 
                 printf("Robot %d, Grid %d: Case 3. Moved sensor %d to cover grid. Stock: %d.\n", node_id, target_grid_idx, sensor_to_activate_id, robot_stock_rs);
@@ -678,26 +1023,14 @@ PROCESS_THREAD(main_node_process, ev, data) {
                 // Collect extra sensors (excluding the one "moved" to cover)
                 int num_collected_this_turn = 0;
                 for (int i = 0; i < collected_list_idx; i++) {
-                    if (sensors_to_collect_node_ids[i] == sensor_to_activate_id) continue; // Don't collect the one used for coverage
+                    int j = sensors_to_collect_slots[i];
+                    if (robot_sensor_db[j].sensor_node_id == sensor_to_activate_id) continue; // Don't collect the one used for coverage
 
                     if (robot_stock_rs < ROBOT_STOCK_CAPACITY) {
-                        for (int j = 0; j < MAX_SENSORS_PER_LA; j++) {
-                            if (robot_sensor_db[j].sensor_node_id == sensors_to_collect_node_ids[i]) {
-                                robot_sensor_db[j].sensor_node_id = 0; // Mark slot as empty
-                                robot_stock_rs++;
-                                num_collected_this_turn++;
-                                // Tell the actual sensor node it is idle/collected
-                                sensor_control_msg.sensor_id = sensors_to_collect_node_ids[i];
-                                sensor_control_msg.activate_status = 0; // Set to Idle
-                                sensor_control_msg.new_coord = robot_sensor_db[j].coord; // Keep its existing coordinate
-                                target_sensor_addr.u8[0] = sensor_control_msg.sensor_id; target_sensor_addr.u8[1] = 0;
-                                packetbuf_copyfrom(&sensor_control_msg, sizeof(sensor_control_msg));
-                                unicast_send(&unicast_conn_general, &target_sensor_addr);
-                                update_transmit_energy(node_id, P_TRANSMIT_ROBOT, sizeof(sensor_control_msg));
-                                update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 50); // For collecting
-                                break;
-                            }
-                        }
+                        num_collected_this_turn++;
+                        stock_collect(robot_sensor_db[j].sensor_node_id);
+                        robot_sensor_db_release(j);
+                        update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 50); // For collecting
                     } else {
                         break; // Stock capacity reached
                     }
@@ -716,6 +1049,25 @@ PROCESS_THREAD(main_node_process, ev, data) {
                 update_processing_energy(node_id, P_PROCESSING_ROBOT, CLOCK_SECOND / 50);
             }
 
+            // Broadcast the grid command; rebroadcast it while sensors have not acked every entry
+            // (globals only from here: locals do not survive the protothread waits)
+            memset(robot_grid_command_acked, 0, sizeof(robot_grid_command_acked));
+            robot_grid_command_sends = 0;
+            while (robot_grid_command.num_entries > 0 && robot_grid_command_sends <= GRID_COMMAND_MAX_RETRIES &&
+                   grid_command_unacked() > 0) {
+                packetbuf_copyfrom(&robot_grid_command, GRID_COMMAND_LEN(robot_grid_command.num_entries));
+                broadcast_send(&broadcast_conn_command);
+                update_transmit_energy(node_id, P_TRANSMIT_ROBOT, GRID_COMMAND_LEN(robot_grid_command.num_entries));
+                robot_grid_command_sends++;
+                etimer_set(&robot_timer, GRID_COMMAND_ACK_WAIT);
+                PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&robot_timer));
+            }
+            if (robot_grid_command.num_entries > 0 && grid_command_unacked() > 0) {
+                printf("Robot %d: %d of %d entries of grid command %d unacked after %d sends.\n", node_id,
+                       grid_command_unacked(), robot_grid_command.num_entries, robot_grid_command.seqno,
+                       robot_grid_command_sends);
+            }
+
             robot_no_p--; // Decrement permissible moves
             // Simulate processing time before next move
             etimer_set(&robot_timer, CLOCK_SECOND / 2);
@@ -724,32 +1076,24 @@ PROCESS_THREAD(main_node_process, ev, data) {
 
         // End of local phase, send message to BS
         printf("Robot %d: Dispersion Phase completed. Covered %d grids in LA %d.\n", node_id, num_covered_grids_in_this_la, robot_current_la_id);
-        robot_pm_msg_t robot_pm;
-        robot_pm.robot_id = node_id;
-        robot_pm.covered_grids_in_la = num_covered_grids_in_this_la;
-
-        rimeaddr_t bs_addr;
-        bs_addr.u8[0] = BS_NODE_ID;
-        bs_addr.u8[1] = 0;
-
-        packetbuf_copyfrom(&robot_pm, sizeof(robot_pm));
-        unicast_send(&unicast_conn_general, &bs_addr);
-        printf("Robot %d: Sent Robot_pM to BS.\n", node_id);
-        update_transmit_energy(node_id, P_TRANSMIT_ROBOT, sizeof(robot_pm));
+        robot_report.robot_id = node_id;
+        robot_report.covered_grids_in_la = num_covered_grids_in_this_la;
+        robot_reports_sent++;
+        robot_report_pending = 1;
+        send_robot_report(NULL);
 
         // Reset for next local phase (if any)
         robot_no_p = MAX_GRIDS_PER_LA; // Reset permissible moves
-        robot_stock_rs = ROBOT_INITIAL_STOCK; // Reset stock for next LA
-
-        etimer_set(&robot_timer, CLOCK_SECOND * 5); // Wait before attempting next LA
-        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&robot_timer));
+        // The stock carries over to the next LA: collected sensors in it are placed there
     }
 
 #elif defined(NODE_TYPE) && NODE_TYPE == NODE_TYPE_SENSOR
     printf("Sensor (Node ID: %d): Starting...\n", node_id);
-    // Open Rime connections for broadcast (from robots) and unicast (to robots and for activation)
+    // Open Rime connections for broadcasts from robots (Mp, grid commands) and unicast to robots (Sensor_M, acks)
     broadcast_open(&broadcast_conn_general, BROADCAST_CHANNEL, &broadcast_callbacks_sensor);
-    unicast_open(&unicast_conn_general, ROBOT_TO_SENSOR_ACTIVATION_PORT, &unicast_callbacks_sensor); // For activation messages
+    broadcast_open(&broadcast_conn_command, ROBOT_TO_SENSOR_COMMAND_CHANNEL, &broadcast_callbacks_sensor_command);
+    unicast_open(&unicast_conn_general, SENSOR_TO_ROBOT_UNICAST_PORT, &unicast_callbacks_sensor);
+    unicast_open(&unicast_conn_ack, SENSOR_TO_ROBOT_ACK_PORT, &unicast_callbacks_sensor_ack);
 
     // Set initial random position for the sensor node.
     // This position will be used for distance calculations. Cooja's visual position is separate.
@@ -759,24 +1103,20 @@ PROCESS_THREAD(main_node_process, ev, data) {
     printf("Sensor %d: Initial position is (%d,%d).\n", node_id, my_sensor_pos.x, my_sensor_pos.y);
     is_sensor_active = 0; // All sensors initially idle as per text
 
-    static struct etimer sensor_timer;
+    sensor_energy_start = clock_seconds();
+    sensor_energy_periods = 0;
 
     while (1) {
-        // Sensor nodes primarily listen for Mp messages and reply.
-        // They also consume baseline energy and sensing energy if active.
-        update_baseline_energy(node_id, P_BASELINE_SENSOR, CLOCK_SECOND);
-
-        if (is_sensor_active) {
-            update_sensing_energy(node_id, SENSOR_SENSING_RANGE);
-            update_processing_energy(node_id, P_PROCESSING_SENSOR, CLOCK_SECOND / 10);
-            // printf("Sensor %d: Active, sensing.\n", node_id); // Commented to reduce output
-        } else {
-            update_idle_radio_energy(node_id, P_IDLE_RADIO_SENSOR, CLOCK_SECOND / 2); // Radio is always on for listening
-            // printf("Sensor %d: Idle, listening.\n", node_id); // Commented to reduce output
-        }
-
-        etimer_set(&sensor_timer, CLOCK_SECOND * 1); // Periodically consume energy and listen
-        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&sensor_timer));
+        // Sensor nodes only react to radio events (Mp, grid commands), handled in the Rime callbacks.
+        // Energy is settled lazily from elapsed time, so the process sleeps until a report is
+        // requested on the serial console (any line, e.g. "energy").
+        PROCESS_WAIT_EVENT_UNTIL(ev == serial_line_event_message);
+        sensor_settle_energy();
+        printf("Sensor %d: %s, energy after %lu s: baseline %.6f J, sensing %.6f J, processing %.6f J, idle radio %.6f J, tx %.6f J, rx %.6f J.\n",
+               node_id, is_sensor_collected ? "collected" : (is_sensor_active ? "active" : "idle"), sensor_energy_periods,
+               node_energy_stats[node_id].total_baseline_energy, node_energy_stats[node_id].total_sensing_energy,
+               node_energy_stats[node_id].total_processing_energy, node_energy_stats[node_id].total_idle_radio_energy,
+               node_energy_stats[node_id].total_transmit_energy, node_energy_stats[node_id].total_receive_energy);
     }
 
 #else
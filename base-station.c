@@ -4,16 +4,30 @@
 #include "net/ipv6/simple-udp.h"
 #include "sys/etimer.h"
 #include "sys/clock.h"
+#include "cfs/cfs.h"
 #include "project-conf.h"
+#include "latency-histogram.h"
+#include "profile-scope.h"
+#include "node-shell.h"
+#include "radio-trace.h"
+#include "obstacle-map.h"
+#if BS_COAP_METRICS_ENABLED
+#include "coap-engine.h"
+#include "cbor-writer.h"
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
 #include "sys/log.h"
 #define LOG_MODULE "BaseStation"
-#define LOG_LEVEL LOG_LEVEL_APP
+#define LOG_LEVEL app_log_level
 
 /* Robot timeout configuration */
+#if MAX_ROBOTS > 255
+#error "Robot IDs are uint8_t: MAX_ROBOTS must not exceed 255"
+#endif
+
 #define ROBOT_TIMEOUT_SECONDS 10
 #define MONITORING_INTERVAL (5 * CLOCK_SECOND)
 
@@ -30,6 +44,7 @@ typedef struct {
     uint8_t assigned_la_id;
     clock_time_t assignment_time;
     uint8_t responsive;
+    uint8_t deployed;           // Robot has been assigned or reported at least once
 } robot_db_record_t;
 
 typedef struct {
@@ -37,12 +52,63 @@ typedef struct {
     uint8_t covered_grids;
 } robot_message_t;
 
+/* Robot_RM: a rebooted robot resuming a journaled local phase */
+typedef struct {
+    uint8_t robot_id;
+    uint8_t la_id;
+    uint8_t next_grid;
+    uint8_t covered_grids;
+} robot_resume_msg_t;
+
+/* Acknowledgement of Robot_RM, carrying the LA now on record for the robot */
+#define RESUME_ACK_MAGIC0 'R'
+#define RESUME_ACK_MAGIC1 'A'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t la_id;
+} robot_resume_ack_msg_t;
+
+/* Robot_HM: progress heartbeat of a robot busy on an LA */
+#define HEARTBEAT_MSG_MAGIC0 'R'
+#define HEARTBEAT_MSG_MAGIC1 'H'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t la_id;
+    uint8_t covered_grids;
+} robot_heartbeat_msg_t;
+
 /* Add message structure at top level */
 typedef struct {
     uint8_t target_robot_id;
     la_db_record_t la_assignment;
 } robot_assignment_msg_t;
 
+/* Checkpoint log record: one LA_DB or Robot_DB delta (last writer wins on replay) */
+typedef enum {
+    CHECKPOINT_REC_HEADER = 0xA5,       // index = format version, value = generation
+    CHECKPOINT_REC_LA = 1,              // index = LA index, value = no_grid
+    CHECKPOINT_REC_ROBOT = 2,           // index = robot id, value = la_id | CHECKPOINT_ROBOT_* flags
+    CHECKPOINT_REC_SNAPSHOT_END = 3     // marks a complete compacted snapshot
+} checkpoint_record_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t index;
+    uint16_t value;
+} checkpoint_record_t;
+
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_BATCH 16                 // Records per cfs_read/cfs_write
+#define CHECKPOINT_ROBOT_RESPONSIVE 0x100
+#define CHECKPOINT_ROBOT_DEPLOYED 0x200
+
+#define BITMAP_BYTES(n) (((n) + 7) / 8)
+#define BITMAP_SET(map, i) ((map)[(i) >> 3] |= (uint8_t)(1 << ((i) & 7)))
+#define BITMAP_TEST(map, i) (((map)[(i) >> 3] >> ((i) & 7)) & 1)
+#define BITMAP_CLEAR(map, i) ((map)[(i) >> 3] &= (uint8_t)~(1 << ((i) & 7)))
+
 /* Base Station State */
 static struct {
     la_db_record_t la_db[MAX_LOCATION_AREAS];
@@ -57,12 +123,37 @@ static struct {
     uint32_t messages_sent;
     uint32_t messages_received;
     uint32_t processing_operations;
+    uint32_t total_processing_operations; // Never reset, for profiling
+    uint32_t total_messages_sent;         // Never reset, for conformance checks
+    uint32_t total_messages_received;
     
     /* Timing */
     clock_time_t start_time;
     clock_time_t last_energy_calc;
+    
+    /* Checkpointing */
+    uint8_t checkpoint_file;      // Active log file (0 or 1)
+    uint16_t checkpoint_generation;
+    uint16_t checkpoint_records;  // Records appended since last compaction
+    uint8_t checkpoint_dirty_las[BITMAP_BYTES(MAX_LOCATION_AREAS)];  // Deltas not yet on flash
+    uint8_t checkpoint_dirty_robots[BITMAP_BYTES(MAX_ROBOTS)];
+    uint8_t checkpoint_torn;      // A short append may have left a partial record in the log
 } base_station;
 
+static const char *const checkpoint_files[2] = { "bs-ckpt-0", "bs-ckpt-1" };
+
+/* Latency histograms */
+static latency_hist_t hist_assign_report;   // Assignment sent -> Robot_pM received
+static latency_hist_t hist_deployment;      // BS start -> all LAs covered
+static const latency_hist_t *const bs_hists[] = { &hist_assign_report, &hist_deployment };
+#define BS_NUM_HISTS (sizeof(bs_hists) / sizeof(bs_hists[0]))
+static uint8_t latency_frame[LATENCY_FRAME_HEADER_LEN + BS_NUM_HISTS * LATENCY_FRAME_ENTRY_LEN];
+
+/* Profiling scopes */
+static profile_scope_t prof_udp_rx = PROFILE_SCOPE_INIT("udp_rx_callback");
+static profile_scope_t prof_timeouts = PROFILE_SCOPE_INIT("check_robot_timeouts_and_reassign");
+static profile_scope_t *const bs_scopes[] = { &prof_udp_rx, &prof_timeouts };
+
 static struct simple_udp_connection udp_conn;
 static struct etimer energy_timer;
 static struct etimer monitoring_timer;
@@ -101,11 +192,565 @@ static void update_energy_consumption() {
     base_station.last_energy_calc = current_time;
     
     /* Reset counters */
+    base_station.total_processing_operations += base_station.processing_operations;
+    base_station.total_messages_sent += base_station.messages_sent;
+    base_station.total_messages_received += base_station.messages_received;
     base_station.processing_operations = 0;
     base_station.messages_sent = 0;
     base_station.messages_received = 0;
 }
 
+/* Checkpoint Operations (append-only CFS log with periodic compaction) */
+#if BS_CHECKPOINT_ENABLED
+static void checkpoint_compact();
+
+static uint16_t checkpoint_robot_value(uint8_t robot_id) {
+    const robot_db_record_t *robot = &base_station.robot_db[robot_id];
+    return robot->assigned_la_id |
+           (robot->responsive ? CHECKPOINT_ROBOT_RESPONSIVE : 0) |
+           (robot->deployed ? CHECKPOINT_ROBOT_DEPLOYED : 0);
+}
+
+/* Deltas are only marked here; radio callbacks never touch flash */
+static void checkpoint_log_la(uint8_t la_index) {
+    BITMAP_SET(base_station.checkpoint_dirty_las, la_index);
+    process_poll(&base_station_process);
+}
+
+static void checkpoint_log_robot(uint8_t robot_id) {
+    BITMAP_SET(base_station.checkpoint_dirty_robots, robot_id);
+    process_poll(&base_station_process);
+}
+
+/* Append one batch; only records that reached flash in full lose their dirty bit */
+static uint8_t checkpoint_append(int fd, const checkpoint_record_t *batch, uint8_t count) {
+    int written = cfs_write(fd, batch, count * sizeof(checkpoint_record_t));
+    uint8_t done = written > 0 ? written / sizeof(checkpoint_record_t) : 0;
+    
+    for (uint8_t i = 0; i < done; i++) {
+        if (batch[i].type == CHECKPOINT_REC_LA) {
+            BITMAP_CLEAR(base_station.checkpoint_dirty_las, batch[i].index);
+        } else {
+            BITMAP_CLEAR(base_station.checkpoint_dirty_robots, batch[i].index);
+        }
+    }
+    base_station.checkpoint_records += done;
+    return written == (int)(count * sizeof(checkpoint_record_t));
+}
+
+/* Append all marked deltas in one open/close, from the process loop */
+static void checkpoint_flush() {
+    checkpoint_record_t batch[CHECKPOINT_BATCH];
+    uint8_t count = 0;
+    uint8_t ok = 1;
+    int fd = -1;
+    
+    if (base_station.checkpoint_torn) {
+        /* Appending after a partial record would misalign the replay */
+        checkpoint_compact();
+        return;
+    }
+    
+    for (uint16_t i = 0; i < base_station.num_location_areas + MAX_ROBOTS && ok; i++) {
+        checkpoint_record_t *record = &batch[count];
+        
+        if (i < base_station.num_location_areas) {
+            if (!BITMAP_TEST(base_station.checkpoint_dirty_las, i)) {
+                continue;
+            }
+            record->type = CHECKPOINT_REC_LA;
+            record->index = i;
+            record->value = base_station.la_db[i].no_grid;
+        } else {
+            uint8_t robot_id = i - base_station.num_location_areas;
+            if (!BITMAP_TEST(base_station.checkpoint_dirty_robots, robot_id)) {
+                continue;
+            }
+            record->type = CHECKPOINT_REC_ROBOT;
+            record->index = robot_id;
+            record->value = checkpoint_robot_value(robot_id);
+        }
+        
+        if (fd < 0) {
+            fd = cfs_open(checkpoint_files[base_station.checkpoint_file], CFS_WRITE | CFS_APPEND);
+            if (fd < 0) {
+                LOG_WARN("Checkpoint: unable to open %s\n", checkpoint_files[base_station.checkpoint_file]);
+                return;
+            }
+        }
+        if (++count == CHECKPOINT_BATCH) {
+            ok = checkpoint_append(fd, batch, count);
+            count = 0;
+        }
+    }
+    if (fd < 0) {
+        return;
+    }
+    if (ok && count > 0) {
+        ok = checkpoint_append(fd, batch, count);
+    }
+    cfs_close(fd);
+    
+    if (!ok) {
+        /* The unwritten deltas stay dirty; a snapshot rewrites them all and
+           replaces the log that may now end in a partial record. If that
+           fails too, the next flush tries again. */
+        LOG_WARN("Checkpoint: short write to %s\n", checkpoint_files[base_station.checkpoint_file]);
+        base_station.checkpoint_torn = 1;
+        checkpoint_compact();
+    } else if (base_station.checkpoint_records >= BS_CHECKPOINT_COMPACT_THRESHOLD) {
+        checkpoint_compact();
+    }
+}
+
+/* Write a full snapshot into the inactive file, then drop the old log */
+static void checkpoint_compact() {
+    uint8_t next_file = base_station.checkpoint_file ^ 1;
+    checkpoint_record_t record;
+    int fd;
+    
+    cfs_remove(checkpoint_files[next_file]);
+    fd = cfs_open(checkpoint_files[next_file], CFS_WRITE);
+    if (fd < 0) {
+        LOG_WARN("Checkpoint: unable to create %s\n", checkpoint_files[next_file]);
+        return;
+    }
+    
+    record.type = CHECKPOINT_REC_HEADER;
+    record.index = CHECKPOINT_VERSION;
+    record.value = base_station.checkpoint_generation + 1;
+    cfs_write(fd, &record, sizeof(record));
+    
+    for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+        if (base_station.la_db[i].no_grid != 0) {
+            record.type = CHECKPOINT_REC_LA;
+            record.index = i;
+            record.value = base_station.la_db[i].no_grid;
+            cfs_write(fd, &record, sizeof(record));
+        }
+    }
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        if (base_station.robot_db[robot_id].deployed) {
+            record.type = CHECKPOINT_REC_ROBOT;
+            record.index = robot_id;
+            record.value = checkpoint_robot_value(robot_id);
+            cfs_write(fd, &record, sizeof(record));
+        }
+    }
+    
+    record.type = CHECKPOINT_REC_SNAPSHOT_END;
+    record.index = 0;
+    record.value = 0;
+    if (cfs_write(fd, &record, sizeof(record)) != sizeof(record)) {
+        /* Incomplete snapshot: keep appending to the old log */
+        cfs_close(fd);
+        cfs_remove(checkpoint_files[next_file]);
+        LOG_WARN("Checkpoint: compaction failed, keeping %s\n",
+                 checkpoint_files[base_station.checkpoint_file]);
+        return;
+    }
+    cfs_close(fd);
+    
+    cfs_remove(checkpoint_files[base_station.checkpoint_file]);
+    base_station.checkpoint_file = next_file;
+    base_station.checkpoint_generation++;
+    base_station.checkpoint_records = 0;
+    base_station.checkpoint_torn = 0;
+    memset(base_station.checkpoint_dirty_las, 0, sizeof(base_station.checkpoint_dirty_las));
+    memset(base_station.checkpoint_dirty_robots, 0, sizeof(base_station.checkpoint_dirty_robots));
+    base_station.processing_operations++;
+    
+    LOG_INFO("Checkpoint compacted into %s (generation %u)\n",
+             checkpoint_files[next_file], base_station.checkpoint_generation);
+}
+
+/* Returns 1 and the generation if the file starts with a valid header and complete snapshot */
+static uint8_t checkpoint_probe(uint8_t file, uint16_t *generation) {
+    checkpoint_record_t record;
+    int fd = cfs_open(checkpoint_files[file], CFS_READ);
+    uint8_t valid = 0;
+    
+    if (fd < 0) {
+        return 0;
+    }
+    if (cfs_read(fd, &record, sizeof(record)) == sizeof(record) &&
+        record.type == CHECKPOINT_REC_HEADER && record.index == CHECKPOINT_VERSION) {
+        *generation = record.value;
+        while (cfs_read(fd, &record, sizeof(record)) == sizeof(record)) {
+            if (record.type == CHECKPOINT_REC_SNAPSHOT_END) {
+                valid = 1;
+                break;
+            }
+        }
+    }
+    cfs_close(fd);
+    return valid;
+}
+
+static void checkpoint_apply(const checkpoint_record_t *record) {
+    switch (record->type) {
+    case CHECKPOINT_REC_LA:
+        if (record->index < base_station.num_location_areas) {
+            base_station.la_db[record->index].no_grid = (uint8_t)record->value;
+        }
+        break;
+    case CHECKPOINT_REC_ROBOT:
+        if (record->index < MAX_ROBOTS) {
+            base_station.robot_db[record->index].robot_id = record->index;
+            base_station.robot_db[record->index].assigned_la_id = record->value & 0xFF;
+            base_station.robot_db[record->index].responsive =
+                (record->value & CHECKPOINT_ROBOT_RESPONSIVE) != 0;
+            base_station.robot_db[record->index].deployed =
+                (record->value & CHECKPOINT_ROBOT_DEPLOYED) != 0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* Replay the newest valid log over the freshly initialized LA_DB.
+   Returns the number of deployed robots restored (0 = fresh deployment). */
+static uint8_t checkpoint_restore() {
+    checkpoint_record_t batch[CHECKPOINT_BATCH];
+    uint16_t generation[2];
+    uint8_t valid[2];
+    uint16_t replayed = 0;
+    int fd;
+    int len;
+    
+    valid[0] = checkpoint_probe(0, &generation[0]);
+    valid[1] = checkpoint_probe(1, &generation[1]);
+    
+    if (!valid[0] && !valid[1]) {
+        /* Fresh deployment: start the log with an empty snapshot so the
+           first deltas already replay after a reboot */
+        cfs_remove(checkpoint_files[0]);
+        cfs_remove(checkpoint_files[1]);
+        base_station.checkpoint_file = 1;
+        checkpoint_compact();
+        return 0;
+    }
+    if (valid[0] && valid[1]) {
+        /* Interrupted compaction left both files; the newer snapshot wins */
+        base_station.checkpoint_file = ((int16_t)(generation[1] - generation[0]) > 0) ? 1 : 0;
+        cfs_remove(checkpoint_files[base_station.checkpoint_file ^ 1]);
+    } else {
+        base_station.checkpoint_file = valid[1] ? 1 : 0;
+    }
+    base_station.checkpoint_generation = generation[base_station.checkpoint_file];
+    
+    fd = cfs_open(checkpoint_files[base_station.checkpoint_file], CFS_READ);
+    if (fd < 0) {
+        return 0;
+    }
+    while ((len = cfs_read(fd, batch, sizeof(batch))) >= (int)sizeof(checkpoint_record_t)) {
+        for (uint8_t i = 0; i < len / sizeof(checkpoint_record_t); i++) {
+            checkpoint_apply(&batch[i]);
+            replayed++;
+        }
+    }
+    cfs_close(fd);
+    
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        if (base_station.robot_db[robot_id].deployed) {
+            base_station.active_robots++;
+        }
+    }
+    
+    LOG_INFO("Checkpoint: replayed %u records from %s (generation %u)\n",
+             replayed, checkpoint_files[base_station.checkpoint_file],
+             base_station.checkpoint_generation);
+    
+    /* Start the new run from a compact snapshot */
+    checkpoint_compact();
+    return base_station.active_robots;
+}
+#else
+#define checkpoint_log_la(la_index)
+#define checkpoint_log_robot(robot_id)
+#define checkpoint_flush()
+#define checkpoint_restore() 0
+#endif /* BS_CHECKPOINT_ENABLED */
+
+/* CoAP Metrics Resources (Observe, CBOR payloads) */
+#if BS_COAP_METRICS_ENABLED
+typedef enum {
+    METRICS_COVERAGE = 0,
+    METRICS_LAS,
+    METRICS_ROBOTS,
+    METRICS_ENERGY,
+    METRICS_COUNT
+} metrics_id_t;
+
+#define METRICS_DIRTY_DB ((1 << METRICS_COVERAGE) | (1 << METRICS_LAS) | (1 << METRICS_ROBOTS))
+#define METRICS_DIRTY_ENERGY (1 << METRICS_ENERGY)
+#define METRICS_MAX_AGE (MONITORING_INTERVAL / CLOCK_SECOND)
+
+/* Encoded payloads are cached until the next flush, so each observer
+   notification is a copy rather than a re-encode */
+static uint8_t metrics_coverage_buf[24];
+static uint8_t metrics_las_buf[4 + MAX_LOCATION_AREAS * 14];
+static uint8_t metrics_robots_buf[4 + MAX_ROBOTS * 12];
+static uint8_t metrics_energy_buf[32];
+
+/* Observe notifications are sent without Block2 and are cut off at
+   COAP_MAX_CHUNK_SIZE, so the two tables only notify a summary
+   {0: version, 1: payload bytes}; observers then GET them block-wise */
+static struct {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t len;
+    uint8_t valid;
+    uint8_t notify_summary;
+    uint16_t version;   // Bumped on every change notification
+} metrics_cache[METRICS_COUNT] = {
+    { metrics_coverage_buf, sizeof(metrics_coverage_buf), 0, 0, 0, 0 },
+    { metrics_las_buf, sizeof(metrics_las_buf), 0, 0, 1, 0 },
+    { metrics_robots_buf, sizeof(metrics_robots_buf), 0, 0, 1, 0 },
+    { metrics_energy_buf, sizeof(metrics_energy_buf), 0, 0, 0, 0 },
+};
+static uint8_t metrics_dirty;
+
+static float calculate_area_coverage_percentage();
+
+/* Coverage: {0: Per_AC in basis points, 1: covered grids, 2: total grids,
+              3: covered LAs, 4: LAs, 5: complete} */
+static void metrics_encode_coverage(cbor_writer_t *w) {
+    uint8_t grids_per_la = (ROBOT_PERCEPTION_RANGE / SENSOR_PERCEPTION_RANGE) *
+                           (ROBOT_PERCEPTION_RANGE / SENSOR_PERCEPTION_RANGE);
+    uint16_t covered_grids = 0;
+    uint8_t covered_las = 0;
+    
+    for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+        covered_grids += base_station.la_db[i].no_grid;
+        covered_las += (base_station.la_db[i].no_grid != 0);
+    }
+    cbor_open_map(w, 6);
+    cbor_put_uint(w, 0);
+    cbor_put_uint(w, (uint32_t)(calculate_area_coverage_percentage() * 100));
+    cbor_put_uint(w, 1);
+    cbor_put_uint(w, covered_grids);
+    cbor_put_uint(w, 2);
+    cbor_put_uint(w, (uint16_t)grids_per_la * base_station.num_location_areas);
+    cbor_put_uint(w, 3);
+    cbor_put_uint(w, covered_las);
+    cbor_put_uint(w, 4);
+    cbor_put_uint(w, base_station.num_location_areas);
+    cbor_put_uint(w, 5);
+    cbor_put_bool(w, covered_las == base_station.num_location_areas);
+}
+
+/* Per-LA status: [[la_id, center_x, center_y, no_grid, robot_id | null], ...] */
+static void metrics_encode_las(cbor_writer_t *w) {
+    cbor_open_array(w, base_station.num_location_areas);
+    for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+        la_db_record_t *la = &base_station.la_db[i];
+        int16_t owner = -1;
+        
+        for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+            if (base_station.robot_db[robot_id].assigned_la_id == la->la_id) {
+                owner = robot_id;
+                break;
+            }
+        }
+        cbor_open_array(w, 5);
+        cbor_put_uint(w, la->la_id);
+        cbor_put_uint(w, la->center_x);
+        cbor_put_uint(w, la->center_y);
+        cbor_put_uint(w, la->no_grid);
+        if (owner >= 0) {
+            cbor_put_uint(w, owner);
+        } else {
+            cbor_put_null(w);
+        }
+    }
+}
+
+/* Robot table: [[robot_id, assigned_la_id, responsive, seconds since assignment], ...] */
+static void metrics_encode_robots(cbor_writer_t *w) {
+    clock_time_t now = clock_time();
+    
+    cbor_open_array(w, MAX_ROBOTS);
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        robot_db_record_t *robot = &base_station.robot_db[robot_id];
+        cbor_open_array(w, 4);
+        cbor_put_uint(w, robot_id);
+        cbor_put_uint(w, robot->assigned_la_id);
+        cbor_put_bool(w, robot->responsive);
+        cbor_put_uint(w, robot->assigned_la_id ? (now - robot->assignment_time) / CLOCK_SECOND : 0);
+    }
+}
+
+/* Energy: {0: processing uJ, 1: radio uJ, 2: total uJ, 3: uptime s} */
+static void metrics_encode_energy(cbor_writer_t *w) {
+    cbor_open_map(w, 4);
+    cbor_put_uint(w, 0);
+    cbor_put_uint(w, (uint32_t)(base_station.processing_energy * 1e6f));
+    cbor_put_uint(w, 1);
+    cbor_put_uint(w, (uint32_t)(base_station.radio_energy * 1e6f));
+    cbor_put_uint(w, 2);
+    cbor_put_uint(w, (uint32_t)(base_station.total_energy_consumed * 1e6f));
+    cbor_put_uint(w, 3);
+    cbor_put_uint(w, (clock_time() - base_station.start_time) / CLOCK_SECOND);
+}
+
+static void (*const metrics_encoders[METRICS_COUNT])(cbor_writer_t *w) = {
+    metrics_encode_coverage, metrics_encode_las, metrics_encode_robots, metrics_encode_energy
+};
+
+/* Serve a cached payload, block-wise when it exceeds the preferred size.
+   Notifications come without an offset and must fit in one message. */
+static void metrics_get(metrics_id_t id, coap_message_t *response, uint8_t *buffer,
+                        uint16_t preferred_size, int32_t *offset) {
+    int32_t start = offset ? *offset : 0;
+    uint16_t chunk;
+    
+    if (!metrics_cache[id].valid) {
+        cbor_writer_t w;
+        cbor_writer_init(&w, metrics_cache[id].buf, metrics_cache[id].size);
+        metrics_encoders[id](&w);
+        if (!cbor_writer_ok(&w)) {
+            LOG_WARN("Metrics: payload %u truncated at %u bytes\n", id, metrics_cache[id].size);
+        }
+        metrics_cache[id].len = w.len;
+        metrics_cache[id].valid = 1;
+        base_station.processing_operations++;
+    }
+    
+    if (!offset && metrics_cache[id].notify_summary) {
+        cbor_writer_t w;
+        cbor_writer_init(&w, buffer, preferred_size);
+        cbor_open_map(&w, 2);
+        cbor_put_uint(&w, 0);
+        cbor_put_uint(&w, metrics_cache[id].version);
+        cbor_put_uint(&w, 1);
+        cbor_put_uint(&w, metrics_cache[id].len);
+        coap_set_header_content_format(response, APPLICATION_CBOR);
+        coap_set_header_max_age(response, METRICS_MAX_AGE);
+        coap_set_payload(response, buffer, w.len);
+        base_station.messages_sent++;
+        return;
+    }
+    if (!offset && metrics_cache[id].len > preferred_size) {
+        /* A truncated CBOR document would not decode */
+        LOG_WARN("Metrics: notification %u of %u bytes exceeds %u\n",
+                 id, metrics_cache[id].len, preferred_size);
+        coap_set_status_code(response, INTERNAL_SERVER_ERROR_5_00);
+        return;
+    }
+    if (start >= metrics_cache[id].len && metrics_cache[id].len > 0) {
+        coap_set_status_code(response, BAD_OPTION_4_02);
+        return;
+    }
+    chunk = metrics_cache[id].len - start;
+    if (chunk > preferred_size) {
+        chunk = preferred_size;
+    }
+    memcpy(buffer, metrics_cache[id].buf + start, chunk);
+    coap_set_header_content_format(response, APPLICATION_CBOR);
+    coap_set_header_max_age(response, METRICS_MAX_AGE);
+    coap_set_payload(response, buffer, chunk);
+    
+    if (offset) {
+        *offset = (start + chunk < metrics_cache[id].len) ? start + chunk : -1;
+    }
+    base_station.messages_sent++;
+}
+
+static void res_coverage_get(coap_message_t *request, coap_message_t *response,
+                             uint8_t *buffer, uint16_t preferred_size, int32_t *offset) {
+    metrics_get(METRICS_COVERAGE, response, buffer, preferred_size, offset);
+}
+
+static void res_las_get(coap_message_t *request, coap_message_t *response,
+                        uint8_t *buffer, uint16_t preferred_size, int32_t *offset) {
+    metrics_get(METRICS_LAS, response, buffer, preferred_size, offset);
+}
+
+static void res_robots_get(coap_message_t *request, coap_message_t *response,
+                           uint8_t *buffer, uint16_t preferred_size, int32_t *offset) {
+    metrics_get(METRICS_ROBOTS, response, buffer, preferred_size, offset);
+}
+
+static void res_energy_get(coap_message_t *request, coap_message_t *response,
+                           uint8_t *buffer, uint16_t preferred_size, int32_t *offset) {
+    metrics_get(METRICS_ENERGY, response, buffer, preferred_size, offset);
+}
+
+static void res_coverage_event();
+static void res_las_event();
+static void res_robots_event();
+static void res_energy_event();
+
+EVENT_RESOURCE(res_coverage, "title=\"Area coverage\";ct=60;obs",
+               res_coverage_get, NULL, NULL, NULL, res_coverage_event);
+EVENT_RESOURCE(res_las, "title=\"LA_DB status\";ct=60;obs",
+               res_las_get, NULL, NULL, NULL, res_las_event);
+EVENT_RESOURCE(res_robots, "title=\"Robot_DB\";ct=60;obs",
+               res_robots_get, NULL, NULL, NULL, res_robots_event);
+EVENT_RESOURCE(res_energy, "title=\"BS energy\";ct=60;obs",
+               res_energy_get, NULL, NULL, NULL, res_energy_event);
+
+static coap_resource_t *const metrics_resources[METRICS_COUNT] = {
+    &res_coverage, &res_las, &res_robots, &res_energy
+};
+
+static void res_coverage_event() {
+    coap_notify_observers(&res_coverage);
+}
+
+static void res_las_event() {
+    coap_notify_observers(&res_las);
+}
+
+static void res_robots_event() {
+    coap_notify_observers(&res_robots);
+}
+
+static void res_energy_event() {
+    coap_notify_observers(&res_energy);
+}
+
+static void metrics_mark_dirty(uint8_t mask) {
+    metrics_dirty |= mask;
+}
+
+/* Coalesce all changes since the last flush into one notification per resource */
+static void metrics_flush() {
+    for (uint8_t id = 0; id < METRICS_COUNT; id++) {
+        if (metrics_dirty & (1 << id)) {
+            metrics_cache[id].valid = 0;
+            metrics_cache[id].version++;
+            metrics_resources[id]->trigger();
+        }
+    }
+    metrics_dirty = 0;
+}
+
+static void metrics_init() {
+    coap_activate_resource(&res_coverage, "metrics/coverage");
+    coap_activate_resource(&res_las, "metrics/las");
+    coap_activate_resource(&res_robots, "metrics/robots");
+    coap_activate_resource(&res_energy, "metrics/energy");
+}
+#else
+#define metrics_mark_dirty(mask)
+#define metrics_flush()
+#define metrics_init()
+#endif /* BS_COAP_METRICS_ENABLED */
+
+/* LA_DB/Robot_DB change hooks: persist the delta and refresh observers */
+static void la_db_changed(uint8_t la_index) {
+    checkpoint_log_la(la_index);
+    metrics_mark_dirty(METRICS_DIRTY_DB);
+}
+
+static void robot_db_changed(uint8_t robot_id) {
+    checkpoint_log_robot(robot_id);
+    metrics_mark_dirty(METRICS_DIRTY_DB);
+}
+
 /* Database Operations */
 static void initialize_la_db() {
     uint8_t la_count = 0;
@@ -135,6 +780,14 @@ static void initialize_la_db() {
     base_station.processing_operations++;
 }
 
+/* First assignment or report from a robot: it now counts as deployed */
+static void robot_mark_deployed(uint8_t robot_id) {
+    if (!base_station.robot_db[robot_id].deployed) {
+        base_station.robot_db[robot_id].deployed = 1;
+        base_station.active_robots++;
+    }
+}
+
 static int8_t find_uncovered_la() {
     for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
         if (base_station.la_db[i].no_grid == 0) {
@@ -144,12 +797,37 @@ static int8_t find_uncovered_la() {
     return -1; // No uncovered LA found
 }
 
+#if OBSTACLE_MAP_ENABLED
+/* Send the robot its LA's obstacle map ahead of the assignment itself */
+static void send_obstacle_map(uint8_t robot_id, uint8_t la_index) {
+    const la_db_record_t *la = &base_station.la_db[la_index];
+    obstacle_map_msg_t map_msg;
+    uip_ipaddr_t robot_addr;
+    
+    map_msg.magic[0] = OBSTACLE_MSG_MAGIC0;
+    map_msg.magic[1] = OBSTACLE_MSG_MAGIC1;
+    map_msg.target_robot_id = robot_id;
+    obstacle_map_extract(la->la_id, la->center_x - ROBOT_PERCEPTION_RANGE / 2,
+                         la->center_y - ROBOT_PERCEPTION_RANGE / 2, &map_msg.map);
+    
+    uip_ip6addr(&robot_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1);
+    simple_udp_sendto(&udp_conn, &map_msg, sizeof(map_msg), &robot_addr);
+    base_station.messages_sent++;
+}
+#endif /* OBSTACLE_MAP_ENABLED */
+
 static void assign_robot_to_la(uint8_t robot_id, uint8_t la_index) {
     if (robot_id < MAX_ROBOTS) {
+#if OBSTACLE_MAP_ENABLED
+        send_obstacle_map(robot_id, la_index);
+#endif /* OBSTACLE_MAP_ENABLED */
+
         base_station.robot_db[robot_id].robot_id = robot_id;
         base_station.robot_db[robot_id].assigned_la_id = base_station.la_db[la_index].la_id;
         base_station.robot_db[robot_id].assignment_time = clock_time();
         base_station.robot_db[robot_id].responsive = 0; // Will be set to 1 when robot responds
+        robot_mark_deployed(robot_id);
+        robot_db_changed(robot_id);
         
         LOG_INFO("Assigned Robot %u to LA %u at (%u, %u)\n", 
                 robot_id, base_station.la_db[la_index].la_id,
@@ -165,11 +843,13 @@ static void update_la_coverage(uint8_t robot_id, uint8_t covered_grids) {
     
     /* Mark robot as responsive */
     base_station.robot_db[robot_id].responsive = 1;
+    robot_mark_deployed(robot_id);
     
     /* Update LA_DB */
     for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
         if (base_station.la_db[i].la_id == assigned_la_id) {
             base_station.la_db[i].no_grid = covered_grids;
+            la_db_changed(i);
             LOG_INFO("Updated LA %u coverage: %u grids covered\n", assigned_la_id, covered_grids);
             break;
         }
@@ -177,17 +857,73 @@ static void update_la_coverage(uint8_t robot_id, uint8_t covered_grids) {
     base_station.processing_operations++;
 }
 
-static float calculate_area_coverage_percentage() {
-    uint16_t total_grids = 0;
-    uint16_t covered_grids = 0;
+static uint8_t la_assigned_to_robot(uint8_t la_id) {
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        if (base_station.robot_db[robot_id].assigned_la_id == la_id) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Resend the robot's in-flight assignment, or hand an idle robot the next
+   uncovered LA nobody is working on; 0 if there is nothing to send */
+static uint8_t resend_robot_assignment(uint8_t robot_id) {
+    uint8_t la_id = base_station.robot_db[robot_id].assigned_la_id;
+    int8_t la_index = -1;
+    uip_ipaddr_t robot_addr;
+    
+    if (la_id != 0) {
+        /* In-flight assignment: resend it and restart the timeout window */
+        for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+            if (base_station.la_db[i].la_id == la_id) {
+                la_index = i;
+                break;
+            }
+        }
+    } else {
+        for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+            if (base_station.la_db[i].no_grid == 0 &&
+                !la_assigned_to_robot(base_station.la_db[i].la_id)) {
+                la_index = i;
+                break;
+            }
+        }
+    }
+    
+    if (la_index < 0) {
+        return 0;
+    }
+    
+    assign_robot_to_la(robot_id, la_index);
+    
+    robot_assignment_msg_t assignment_msg;
+    assignment_msg.target_robot_id = robot_id;
+    assignment_msg.la_assignment = base_station.la_db[la_index];
+    uip_ip6addr(&robot_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1);
+    simple_udp_sendto(&udp_conn, &assignment_msg, sizeof(assignment_msg), &robot_addr);
+    base_station.messages_sent++;
+    return 1;
+}
+
+/* Covered grids and NO_G * NO_LA, the terms of Per_AC */
+static void count_area_grids(uint16_t *covered_grids, uint16_t *total_grids) {
     uint8_t grids_per_la = (ROBOT_PERCEPTION_RANGE / SENSOR_PERCEPTION_RANGE) * 
                           (ROBOT_PERCEPTION_RANGE / SENSOR_PERCEPTION_RANGE);
     
+    *covered_grids = 0;
+    *total_grids = 0;
     for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
-        total_grids += grids_per_la;
-        covered_grids += base_station.la_db[i].no_grid;
+        *total_grids += grids_per_la;
+        *covered_grids += base_station.la_db[i].no_grid;
     }
+}
+
+static float calculate_area_coverage_percentage() {
+    uint16_t total_grids;
+    uint16_t covered_grids;
     
+    count_area_grids(&covered_grids, &total_grids);
     return total_grids > 0 ? ((float)covered_grids / total_grids) * 100.0 : 0.0;
 }
 
@@ -212,6 +948,7 @@ static void check_robot_timeouts_and_reassign() {
                 for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
                     if (base_station.la_db[i].la_id == timed_out_la_id) {
                         base_station.la_db[i].no_grid = 0;
+                        la_db_changed(i);
                         LOG_INFO("Reset LA %u to uncovered due to robot timeout\n", timed_out_la_id);
                         break;
                     }
@@ -220,6 +957,7 @@ static void check_robot_timeouts_and_reassign() {
                 /* Clear robot assignment */
                 base_station.robot_db[robot_id].assigned_la_id = 0;
                 base_station.robot_db[robot_id].responsive = 0;
+                robot_db_changed(robot_id);
                 
                 /* Try to find a responsive robot to reassign to this LA */
                 for (uint8_t responsive_robot = 0; responsive_robot < MAX_ROBOTS; responsive_robot++) {
@@ -267,6 +1005,7 @@ static void check_robot_timeouts_and_reassign() {
         static bool completion_reported = false;
         if (!completion_reported) {
             float coverage_percentage = calculate_area_coverage_percentage();
+            latency_hist_record(&hist_deployment, clock_time() - base_station.start_time);
             LOG_INFO("=== DEPLOYMENT COMPLETE ===\n");
             LOG_INFO("All location areas covered\n");
             LOG_INFO("Final area coverage: %.2f%%\n", coverage_percentage);
@@ -288,17 +1027,49 @@ static void udp_rx_callback(struct simple_udp_connection *c,
     
     base_station.messages_received++;
     
+    if (latency_is_request(data, datalen)) {
+        uint16_t frame_len = latency_frame_build(LATENCY_NODE_BS, bs_hists, BS_NUM_HISTS,
+                                                 latency_frame, sizeof(latency_frame));
+        simple_udp_sendto(&udp_conn, latency_frame, frame_len, sender_addr);
+        base_station.messages_sent++;
+        return;
+    }
+    
+    /* Heartbeats only keep the timeout window open: no Robot_DB change to persist */
+    if (datalen == sizeof(robot_heartbeat_msg_t) && data[0] == HEARTBEAT_MSG_MAGIC0 &&
+        data[1] == HEARTBEAT_MSG_MAGIC1) {
+        const robot_heartbeat_msg_t *msg = (const robot_heartbeat_msg_t *)data;
+        
+        if (msg->robot_id < MAX_ROBOTS &&
+            base_station.robot_db[msg->robot_id].assigned_la_id == msg->la_id) {
+            base_station.robot_db[msg->robot_id].assignment_time = clock_time();
+        }
+        base_station.processing_operations++;
+        return;
+    }
+    
     if (datalen == sizeof(robot_message_t)) {
         robot_message_t *msg = (robot_message_t *)data;
         
+        if (msg->robot_id >= MAX_ROBOTS) {
+            LOG_WARN("Robot_%uM ignored: robot ID beyond MAX_ROBOTS (%u)\n", msg->robot_id, MAX_ROBOTS);
+            return;
+        }
+        
         LOG_INFO("Received Robot_%uM: (%u, %u) - coverage report\n", 
                 msg->robot_id, msg->robot_id, msg->covered_grids);
         
+        if (base_station.robot_db[msg->robot_id].assigned_la_id != 0) {
+            latency_hist_record(&hist_assign_report,
+                                clock_time() - base_station.robot_db[msg->robot_id].assignment_time);
+        }
+        
         /* Update LA coverage */
         update_la_coverage(msg->robot_id, msg->covered_grids);
         
         /* Clear assignment since this robot completed its task */
         base_station.robot_db[msg->robot_id].assigned_la_id = 0;
+        robot_db_changed(msg->robot_id);
         
         /* Global Phase Algorithm: Search for next uncovered LA as per APP_I */
         int8_t next_la = find_uncovered_la();
@@ -319,9 +1090,66 @@ static void udp_rx_callback(struct simple_udp_connection *c,
             /* No more uncovered LAs found - robot is now available */
             LOG_INFO("Global Phase: No uncovered LAs remain. Robot %u is now available.\n", msg->robot_id);
         }
+    } else if (datalen == sizeof(robot_resume_msg_t)) {
+        robot_resume_msg_t *msg = (robot_resume_msg_t *)data;
+        
+        if (msg->robot_id >= MAX_ROBOTS) {
+            return;
+        }
+        
+        LOG_INFO("Received Robot_%uRM: resuming LA %u at grid %u, %u grids covered\n",
+                msg->robot_id, msg->la_id, msg->next_grid, msg->covered_grids);
+        
+        robot_db_record_t *robot = &base_station.robot_db[msg->robot_id];
+        if (robot->assigned_la_id == msg->la_id) {
+            /* Still ours: restart the timeout window instead of reassigning */
+            robot->assignment_time = clock_time();
+            robot->responsive = 1;
+            robot_db_changed(msg->robot_id);
+        } else if (robot->assigned_la_id == 0 && !la_assigned_to_robot(msg->la_id)) {
+            /* Timed out but not handed to anyone else yet: give the LA back */
+            robot->robot_id = msg->robot_id;
+            robot->assigned_la_id = msg->la_id;
+            robot->assignment_time = clock_time();
+            robot->responsive = 1;
+            robot_mark_deployed(msg->robot_id);
+            robot_db_changed(msg->robot_id);
+            LOG_INFO("Re-bound LA %u to resuming Robot %u\n", msg->la_id, msg->robot_id);
+        } else {
+            LOG_WARN("Robot %u resume for LA %u conflicts with current assignment (LA %u)\n",
+                    msg->robot_id, msg->la_id, robot->assigned_la_id);
+        }
+        
+        /* The robot resends Robot_RM until this arrives */
+        robot_resume_ack_msg_t ack;
+        ack.magic[0] = RESUME_ACK_MAGIC0;
+        ack.magic[1] = RESUME_ACK_MAGIC1;
+        ack.robot_id = msg->robot_id;
+        ack.la_id = robot->assigned_la_id;
+        simple_udp_sendto(&udp_conn, &ack, sizeof(ack), sender_addr);
+        base_station.messages_sent++;
+        base_station.processing_operations++;
+        
+        if (ack.la_id != msg->la_id) {
+            /* The robot drops its journaled LA on this ack; send it the LA
+               on record, or a free one, after the ack */
+            resend_robot_assignment(msg->robot_id);
+        }
     }
 }
 
+static void udp_rx_profiled(struct simple_udp_connection *c,
+                            const uip_ipaddr_t *sender_addr,
+                            uint16_t sender_port,
+                            const uip_ipaddr_t *receiver_addr,
+                            uint16_t receiver_port,
+                            const uint8_t *data,
+                            uint16_t datalen) {
+    radio_trace_record(sender_addr, sender_port, receiver_addr, receiver_port, data, datalen);
+    PROFILE_CALL(prof_udp_rx, udp_rx_callback(c, sender_addr, sender_port, receiver_addr,
+                                              receiver_port, data, datalen));
+}
+
 static void deploy_initial_robots() {
     /* Deploy Robot 0 to first LA (LA_id_1) as per APP_I specification */
     uint8_t la_index = 0; // First LA (LA_id_1)
@@ -358,10 +1186,26 @@ static void deploy_initial_robots() {
                 base_station.la_db[la_index].la_id);
     }
     
-    base_station.active_robots = (base_station.num_location_areas > 1) ? 2 : 1;
     LOG_INFO("Initial deployment complete: %u robots deployed as per APP_I\n", base_station.active_robots);
 }
 
+/* Resume the global phase from a restored checkpoint instead of redeploying from LA 1 */
+static void resume_from_checkpoint() {
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        if (!base_station.robot_db[robot_id].deployed) {
+            /* Never registered before the reboot: nothing to resume */
+            continue;
+        }
+        if (resend_robot_assignment(robot_id)) {
+            LOG_INFO("Resumed Robot %u on LA %u from checkpoint\n",
+                    robot_id, base_station.robot_db[robot_id].assigned_la_id);
+        }
+    }
+    
+    LOG_INFO("Global phase resumed from checkpoint: %.2f%% area already covered\n",
+             calculate_area_coverage_percentage());
+}
+
 static void print_energy_report() {
     update_energy_consumption();
     
@@ -375,9 +1219,128 @@ static void print_energy_report() {
     LOG_INFO("Processing energy: %.6f J\n", base_station.processing_energy);
     LOG_INFO("Radio energy: %.6f J\n", base_station.radio_energy);
     LOG_INFO("Total base station energy: %.6f J\n", base_station.total_energy_consumed);
+    
+    /* Cumulative counters and per-LA state for tools/paper-bench.py and rstore.py */
+    uint16_t covered_grids;
+    uint16_t total_grids;
+    count_area_grids(&covered_grids, &total_grids);
+    LOG_INFO("PAPER_BS, %.3f, %lu, %lu, %lu, %.9f, %.9f, %.9f, %.4f, %u, %u\n",
+             elapsed_seconds, (unsigned long)base_station.total_processing_operations,
+             (unsigned long)base_station.total_messages_sent,
+             (unsigned long)base_station.total_messages_received,
+             base_station.processing_energy, base_station.radio_energy,
+             base_station.total_energy_consumed, coverage_percentage, covered_grids, total_grids);
+    for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+        const la_db_record_t *la = &base_station.la_db[i];
+        int16_t owner = -1;
+        for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+            if (base_station.robot_db[robot_id].assigned_la_id == la->la_id) {
+                owner = robot_id;
+                break;
+            }
+        }
+        LOG_INFO("PAPER_LA, %u, %u, %u, %u, %d\n",
+                 la->la_id, la->center_x, la->center_y, la->no_grid, owner);
+    }
+    for (uint8_t i = 0; i < BS_NUM_HISTS; i++) {
+        latency_hist_log(bs_hists[i]);
+    }
     LOG_INFO("==============================\n");
 }
 
+static void print_profile_report() {
+    LOG_INFO("Processing operations (cumulative): %lu\n",
+             (unsigned long)(base_station.total_processing_operations + base_station.processing_operations));
+    profile_report_log("BS", 0, bs_scopes, sizeof(bs_scopes) / sizeof(bs_scopes[0]));
+}
+
+/* Shell Commands (live inspection over the serial console) */
+#if NODE_SHELL_ENABLED
+static PT_THREAD(cmd_la_db(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "LA_DB: %u location areas\n", base_station.num_location_areas);
+    SHELL_OUTPUT(output, "la_id, center_x, center_y, no_grid, robot\n");
+    for (uint8_t i = 0; i < base_station.num_location_areas; i++) {
+        const la_db_record_t *la = &base_station.la_db[i];
+        int16_t owner = -1;
+        
+        for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+            if (base_station.robot_db[robot_id].assigned_la_id == la->la_id) {
+                owner = robot_id;
+                break;
+            }
+        }
+        if (owner >= 0) {
+            SHELL_OUTPUT(output, "%u, %u, %u, %u, %d\n",
+                         la->la_id, la->center_x, la->center_y, la->no_grid, owner);
+        } else {
+            SHELL_OUTPUT(output, "%u, %u, %u, %u, -\n",
+                         la->la_id, la->center_x, la->center_y, la->no_grid);
+        }
+    }
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_robot_db(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Robot_DB: %u active robots\n", base_station.active_robots);
+    SHELL_OUTPUT(output, "robot_id, la_id, responsive, assigned_s_ago\n");
+    for (uint8_t robot_id = 0; robot_id < MAX_ROBOTS; robot_id++) {
+        const robot_db_record_t *robot = &base_station.robot_db[robot_id];
+        SHELL_OUTPUT(output, "%u, %u, %u, %lu\n", robot_id, robot->assigned_la_id, robot->responsive,
+                     (unsigned long)(robot->assigned_la_id ?
+                                     (clock_time() - robot->assignment_time) / CLOCK_SECOND : 0));
+    }
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_energy(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    update_energy_consumption();
+    SHELL_OUTPUT(output, "Area coverage: %.2f%%\n", calculate_area_coverage_percentage());
+    SHELL_OUTPUT(output, "Processing energy: %.6f J\n", base_station.processing_energy);
+    SHELL_OUTPUT(output, "Radio energy: %.6f J\n", base_station.radio_energy);
+    SHELL_OUTPUT(output, "Total energy: %.6f J\n", base_station.total_energy_consumed);
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_profile(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Processing operations (cumulative): %lu\n",
+                 (unsigned long)(base_station.total_processing_operations + base_station.processing_operations));
+    node_shell_profile(output, bs_scopes, sizeof(bs_scopes) / sizeof(bs_scopes[0]));
+    
+    PT_END(pt);
+}
+
+static const struct shell_command_t bs_shell_commands[] = {
+    { "la-db", cmd_la_db, "'> la-db': Dump LA_DB with coverage and assigned robot" },
+    { "robot-db", cmd_robot_db, "'> robot-db': Dump Robot_DB" },
+    { "energy", cmd_energy, "'> energy': Show coverage and energy counters" },
+    { "profile", cmd_profile, "'> profile': Show profiling scope counters" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t bs_shell_command_set = {
+    .next = NULL,
+    .commands = bs_shell_commands,
+};
+#endif /* NODE_SHELL_ENABLED */
+
+#if RADIO_REPLAY_ENABLED
+static void replay_done() {
+    print_energy_report();
+    print_profile_report();
+}
+#endif /* RADIO_REPLAY_ENABLED */
+
 PROCESS_THREAD(base_station_process, ev, data) {
     PROCESS_BEGIN();
     
@@ -388,17 +1351,37 @@ PROCESS_THREAD(base_station_process, ev, data) {
     base_station.start_time = clock_time();
     base_station.last_energy_calc = base_station.start_time;
     
+    latency_hist_init(&hist_assign_report, "assign->report");
+    latency_hist_init(&hist_deployment, "deployment");
+    
     /* Initialize DAG root */
     NETSTACK_ROUTING.root_start();
     
     /* Initialize UDP connection */
-    simple_udp_register(&udp_conn, UDP_SERVER_PORT, NULL, UDP_CLIENT_PORT, udp_rx_callback);
+    simple_udp_register(&udp_conn, UDP_SERVER_PORT, NULL, UDP_CLIENT_PORT, udp_rx_profiled);
+    radio_replay_start(&udp_conn, udp_rx_profiled, replay_done);
+    
+    /* Expose observable metrics resources */
+    metrics_init();
+    
+    /* Register inspection commands on the serial shell */
+    node_shell_init(&bs_shell_command_set);
     
     /* Initialize databases */
     initialize_la_db();
+#if OBSTACLE_MAP_ENABLED
+    uint16_t blocked_cells, no_deploy_cells;
+    obstacle_map_stats(&blocked_cells, &no_deploy_cells);
+    LOG_INFO("Obstacle map: %ux%u cells of %u m, %u blocked, %u not deployable\n",
+             OBSTACLE_MAP_WIDTH, OBSTACLE_MAP_HEIGHT, OBSTACLE_CELL, blocked_cells, no_deploy_cells);
+#endif /* OBSTACLE_MAP_ENABLED */
     
-    /* Deploy initial robots */
-    deploy_initial_robots();
+    /* Resume from the flash checkpoint if one exists, otherwise deploy initial robots */
+    if (checkpoint_restore() > 0) {
+        resume_from_checkpoint();
+    } else {
+        deploy_initial_robots();
+    }
     
     /* Set timers */
     etimer_set(&energy_timer, ENERGY_REPORT_INTERVAL);
@@ -410,13 +1393,21 @@ PROCESS_THREAD(base_station_process, ev, data) {
     while(1) {
         PROCESS_WAIT_EVENT();
         
+        if (ev == PROCESS_EVENT_POLL) {
+            checkpoint_flush();
+        }
+        
         if (ev == PROCESS_EVENT_TIMER && data == &energy_timer) {
             print_energy_report();
+            print_profile_report();
+            metrics_mark_dirty(METRICS_DIRTY_ENERGY);
+            metrics_flush();
             etimer_reset(&energy_timer);
         }
         
         if (ev == PROCESS_EVENT_TIMER && data == &monitoring_timer) {
-            check_robot_timeouts_and_reassign();
+            PROFILE_CALL(prof_timeouts, check_robot_timeouts_and_reassign());
+            metrics_flush();
             etimer_reset(&monitoring_timer);
         }
     }
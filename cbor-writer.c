@@ -0,0 +1,85 @@
+#include "cbor-writer.h"
+#include <string.h>
+
+#define CBOR_MAJOR_UINT 0
+#define CBOR_MAJOR_NEGINT 1
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_FALSE 20
+#define CBOR_TRUE 21
+#define CBOR_NULL 22
+
+static void put_byte(cbor_writer_t *w, uint8_t byte) {
+    if (w->len < w->size) {
+        w->buf[w->len++] = byte;
+    } else {
+        w->overflow = 1;
+    }
+}
+
+/* Initial byte plus the shortest argument encoding */
+static void put_head(cbor_writer_t *w, uint8_t major, uint32_t value) {
+    major <<= 5;
+    if (value < 24) {
+        put_byte(w, major | value);
+    } else if (value <= 0xFF) {
+        put_byte(w, major | 24);
+        put_byte(w, value);
+    } else if (value <= 0xFFFF) {
+        put_byte(w, major | 25);
+        put_byte(w, value >> 8);
+        put_byte(w, value);
+    } else {
+        put_byte(w, major | 26);
+        put_byte(w, value >> 24);
+        put_byte(w, value >> 16);
+        put_byte(w, value >> 8);
+        put_byte(w, value);
+    }
+}
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, uint16_t size) {
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = 0;
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint32_t value) {
+    put_head(w, CBOR_MAJOR_UINT, value);
+}
+
+void cbor_put_int(cbor_writer_t *w, int32_t value) {
+    if (value >= 0) {
+        put_head(w, CBOR_MAJOR_UINT, value);
+    } else {
+        put_head(w, CBOR_MAJOR_NEGINT, (uint32_t)(-1 - value));
+    }
+}
+
+void cbor_put_bool(cbor_writer_t *w, uint8_t value) {
+    put_byte(w, (CBOR_MAJOR_SIMPLE << 5) | (value ? CBOR_TRUE : CBOR_FALSE));
+}
+
+void cbor_put_null(cbor_writer_t *w) {
+    put_byte(w, (CBOR_MAJOR_SIMPLE << 5) | CBOR_NULL);
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *text) {
+    uint16_t text_len = strlen(text);
+    put_head(w, CBOR_MAJOR_TEXT, text_len);
+    for (uint16_t i = 0; i < text_len; i++) {
+        put_byte(w, text[i]);
+    }
+}
+
+void cbor_open_array(cbor_writer_t *w, uint16_t items) {
+    put_head(w, CBOR_MAJOR_ARRAY, items);
+}
+
+void cbor_open_map(cbor_writer_t *w, uint16_t pairs) {
+    put_head(w, CBOR_MAJOR_MAP, pairs);
+}
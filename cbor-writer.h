@@ -0,0 +1,28 @@
+#ifndef CBOR_WRITER_H_
+#define CBOR_WRITER_H_
+
+#include <stdint.h>
+
+/* Minimal definite-length CBOR encoder (RFC 8949) for metrics payloads.
+   Writes never overrun the buffer; check cbor_writer_ok() after encoding. */
+typedef struct {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t len;
+    uint8_t overflow;
+} cbor_writer_t;
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, uint16_t size);
+void cbor_put_uint(cbor_writer_t *w, uint32_t value);
+void cbor_put_int(cbor_writer_t *w, int32_t value);
+void cbor_put_bool(cbor_writer_t *w, uint8_t value);
+void cbor_put_null(cbor_writer_t *w);
+void cbor_put_text(cbor_writer_t *w, const char *text);
+void cbor_open_array(cbor_writer_t *w, uint16_t items);
+void cbor_open_map(cbor_writer_t *w, uint16_t pairs);
+
+static inline uint8_t cbor_writer_ok(const cbor_writer_t *w) {
+    return !w->overflow;
+}
+
+#endif /* CBOR_WRITER_H_ */
@@ -0,0 +1,45 @@
+#ifndef COVERAGE_RASTER_H_
+#define COVERAGE_RASTER_H_
+
+#include <stdint.h>
+
+/* Geometric coverage of the target area: sensing discs rasterized onto square
+   cells of cell_size metres, one bit per cell. A cell is covered by a disc
+   when its centre lies inside the disc. Level j (0-based) holds the cells
+   covered by at least j + 1 discs, so counting k-coverage is a popcount over
+   one level. Rows are padded to whole 64-bit words. */
+typedef struct {
+    uint16_t width;               // Cells per row
+    uint16_t height;              // Rows
+    uint16_t words_per_row;
+    uint8_t levels;               // Highest k tracked
+    float cell_size;              // Metres per cell side
+    uint64_t *bits;               // levels * height * words_per_row words, owned by the caller
+} coverage_raster_t;
+
+/* Words of storage for a width x height raster tracking `levels` coverage levels */
+#define COVERAGE_RASTER_WORDS(width, height, levels) \
+    ((uint32_t)(levels) * (height) * (((width) + 63) / 64))
+
+void coverage_raster_init(coverage_raster_t *raster, uint64_t *bits, uint16_t width,
+                          uint16_t height, uint8_t levels, float cell_size);
+
+/* Uncover every cell */
+void coverage_raster_clear(coverage_raster_t *raster);
+
+/* Add one sensing disc; position and radius in metres. Parts outside the
+   raster are clipped. */
+void coverage_raster_add_disc(coverage_raster_t *raster, float x, float y, float radius);
+
+/* 1 if every cell of the disc (clipped to the raster) is covered by at least
+   k discs already added, e.g. to find sensors whose area others k-cover */
+uint8_t coverage_raster_disc_covered(const coverage_raster_t *raster, float x, float y,
+                                     float radius, uint8_t k);
+
+/* Cells covered by at least k discs (1 <= k <= levels) */
+uint32_t coverage_raster_count(const coverage_raster_t *raster, uint8_t k);
+
+/* The same as a percentage of the raster area */
+float coverage_raster_percentage(const coverage_raster_t *raster, uint8_t k);
+
+#endif /* COVERAGE_RASTER_H_ */
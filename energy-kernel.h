@@ -0,0 +1,46 @@
+#ifndef ENERGY_KERNEL_H_
+#define ENERGY_KERNEL_H_
+
+#include "energy-model.h"
+#include <stdint.h>
+
+/* Struct-of-arrays sensor state for batched energy integration (native
+   lifetime simulations). Each array has `capacity` entries, owned by the
+   caller. Operation counters hold the operations since the last integration
+   step and are cleared by it, exactly like update_energy_consumption() in
+   sensor-node.c. */
+typedef struct {
+    uint32_t capacity;
+    
+    /* Operation counters since the last step */
+    uint32_t *sensing_ops;
+    uint32_t *processing_ops;
+    uint32_t *tx_ops;
+    uint32_t *rx_ops;
+    uint8_t *active;              // 1 = SENSOR_MODE_ACTIVE, 0 = idle
+    
+    /* Accumulated energy terms and E_active / E_idle, in J */
+    float *baseline_energy;
+    float *sensing_energy;
+    float *processing_energy;
+    float *radio_energy;
+    float *total_energy;
+    
+    /* SENSOR_BATTERY_CAPACITY - total_energy, never below 0 */
+    float *residual_energy;
+} energy_soa_t;
+
+/* Integrate nodes [first, first + count) over time_elapsed seconds. The
+   result is bit-identical to running the scalar model on each node. */
+void energy_kernel_step(const energy_soa_t *soa, uint32_t first, uint32_t count,
+                        float time_elapsed);
+
+/* Integrate a span of time with no operations, as the lifetime mode does
+   between events: only the baseline term grows. */
+void energy_kernel_idle_step(const energy_soa_t *soa, uint32_t first, uint32_t count,
+                             float time_elapsed);
+
+/* Number of nodes in [first, first + count) with no residual energy left */
+uint32_t energy_kernel_count_depleted(const energy_soa_t *soa, uint32_t first, uint32_t count);
+
+#endif /* ENERGY_KERNEL_H_ */
@@ -0,0 +1,44 @@
+#ifndef ENERGY_MODEL_H_
+#define ENERGY_MODEL_H_
+
+#include "project-conf.h"
+#include <stdint.h>
+
+/* Sensor energy terms of the main.tex model. sensor-node.c and the batched
+   kernel (energy-kernel.c) both use these, so a node integrated either way
+   rounds identically: every term is computed in double from the double
+   constants and rounded to float once, before it is accumulated. */
+
+#define ENERGY_AVG_OP_TIME ((float)0.001)   // 1ms per processing/tx/rx operation
+
+static inline float energy_sensor_baseline(float time_duration) {
+    return time_duration * P_BASELINE_SENSOR;
+}
+
+static inline float energy_sensor_sensing(uint32_t sensing_ops) {
+    // E_sensing = μ * r_i^2 (from LaTeX document)
+    float sensing_range_sq = SENSOR_PERCEPTION_RANGE * SENSOR_PERCEPTION_RANGE;
+    return sensing_ops * MU_SENSING * sensing_range_sq;
+}
+
+static inline float energy_sensor_processing(uint32_t processing_ops, float processing_time) {
+    return processing_ops * P_PROCESSING_SENSOR * processing_time;
+}
+
+static inline float energy_sensor_radio(uint32_t tx_ops, uint32_t rx_ops,
+                                        float avg_tx_time, float avg_rx_time) {
+    float tx_energy = tx_ops * P_TRANSMIT_SENSOR * avg_tx_time;
+    float rx_energy = rx_ops * P_RECEIVE_SENSOR * avg_rx_time;
+    return tx_energy + rx_energy;
+}
+
+/* E_active = baseline + sensing + processing + radio, E_idle = baseline + radio.
+   Both sums are formed first so the choice is a select, not a branch. */
+static inline float energy_sensor_total(uint8_t active, float baseline, float sensing,
+                                        float processing, float radio) {
+    float active_total = baseline + sensing + processing + radio;
+    float idle_total = baseline + radio;
+    return active ? active_total : idle_total;
+}
+
+#endif /* ENERGY_MODEL_H_ */
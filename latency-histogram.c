@@ -0,0 +1,112 @@
+#include "latency-histogram.h"
+#include <string.h>
+
+#include "node-shell.h"
+#include "sys/log.h"
+#define LOG_MODULE "Latency"
+#define LOG_LEVEL app_log_level
+
+static uint8_t bucket_for(uint32_t ms) {
+    uint8_t bucket = 0;
+    while (ms != 0 && bucket < LATENCY_HIST_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static uint32_t bucket_upper_ms(uint8_t bucket) {
+    return (bucket == 0) ? 0 : (uint32_t)((1UL << bucket) - 1);
+}
+
+void latency_hist_init(latency_hist_t *hist, const char *name) {
+    hist->name = name;
+    latency_hist_reset(hist);
+}
+
+void latency_hist_reset(latency_hist_t *hist) {
+    hist->count = 0;
+    hist->max_ms = 0;
+    memset(hist->buckets, 0, sizeof(hist->buckets));
+}
+
+void latency_hist_record(latency_hist_t *hist, clock_time_t elapsed) {
+    uint32_t ms = (uint32_t)(((uint64_t)elapsed * 1000) / CLOCK_SECOND);
+    uint8_t bucket = bucket_for(ms);
+    
+    if (hist->buckets[bucket] < 0xFFFF) {
+        hist->buckets[bucket]++;
+    }
+    if (hist->count < 0xFFFF) {
+        hist->count++;
+    }
+    if (ms > hist->max_ms) {
+        hist->max_ms = ms;
+    }
+}
+
+/* Upper bound of the bucket holding the given percentile (max_ms for the open bucket) */
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint8_t percent) {
+    uint32_t target = ((uint32_t)hist->count * percent + 99) / 100;
+    uint32_t seen = 0;
+    
+    if (hist->count == 0) {
+        return 0;
+    }
+    for (uint8_t bucket = 0; bucket < LATENCY_HIST_BUCKETS; bucket++) {
+        seen += hist->buckets[bucket];
+        if (seen >= target) {
+            uint32_t upper = bucket_upper_ms(bucket);
+            return (bucket == LATENCY_HIST_BUCKETS - 1 || upper > hist->max_ms) ? hist->max_ms : upper;
+        }
+    }
+    return hist->max_ms;
+}
+
+void latency_hist_log(const latency_hist_t *hist) {
+    LOG_INFO("%s: n=%u p50<=%lu ms p99<=%lu ms max=%lu ms\n", hist->name, hist->count,
+             (unsigned long)latency_hist_percentile(hist, 50),
+             (unsigned long)latency_hist_percentile(hist, 99), (unsigned long)hist->max_ms);
+}
+
+uint8_t latency_is_request(const uint8_t *data, uint16_t datalen) {
+    return datalen == sizeof(latency_request_msg_t) &&
+           data[0] == LATENCY_REQ_MAGIC0 && data[1] == LATENCY_REQ_MAGIC1;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t value) {
+    *p++ = value & 0xFF;
+    *p++ = value >> 8;
+    return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value) {
+    p = put_u16(p, value & 0xFFFF);
+    return put_u16(p, value >> 16);
+}
+
+uint16_t latency_frame_build(uint8_t node_type, const latency_hist_t *const *hists,
+                             uint8_t num_hists, uint8_t *buf, uint16_t buf_len) {
+    uint16_t frame_len = LATENCY_FRAME_HEADER_LEN + num_hists * LATENCY_FRAME_ENTRY_LEN;
+    uint8_t *p = buf;
+    
+    if (frame_len > buf_len) {
+        return 0;
+    }
+    
+    *p++ = LATENCY_REQ_MAGIC0;
+    *p++ = LATENCY_REQ_MAGIC1;
+    *p++ = LATENCY_FRAME_VERSION;
+    *p++ = node_type;
+    *p++ = num_hists;
+    
+    for (uint8_t i = 0; i < num_hists; i++) {
+        *p++ = i;
+        p = put_u16(p, hists[i]->count);
+        p = put_u32(p, hists[i]->max_ms);
+        for (uint8_t bucket = 0; bucket < LATENCY_HIST_BUCKETS; bucket++) {
+            p = put_u16(p, hists[i]->buckets[bucket]);
+        }
+    }
+    return frame_len;
+}
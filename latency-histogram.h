@@ -0,0 +1,50 @@
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include "contiki.h"
+#include <stdint.h>
+
+/* Fixed-bucket log2 latency histograms in milliseconds.
+   Bucket 0 holds 0 ms, bucket b (b >= 1) holds [2^(b-1), 2^b - 1] ms,
+   and the last bucket is open-ended. */
+#define LATENCY_HIST_BUCKETS 16
+
+/* Node types reported in the binary frame */
+#define LATENCY_NODE_BS 1
+#define LATENCY_NODE_ROBOT 2
+#define LATENCY_NODE_SENSOR 3
+
+typedef struct {
+    const char *name;
+    uint16_t count;
+    uint32_t max_ms;  // 32 bits: phase durations run to minutes
+    uint16_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+/* Histogram dump request (3 bytes, distinct from all protocol messages) */
+#define LATENCY_REQ_MAGIC0 'L'
+#define LATENCY_REQ_MAGIC1 'H'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t version;
+} latency_request_msg_t;
+
+/* Binary frame: header followed by one packed entry per histogram */
+#define LATENCY_FRAME_VERSION 2
+#define LATENCY_FRAME_HEADER_LEN 5   // magic[2], version, node_type, num_hists
+#define LATENCY_FRAME_ENTRY_LEN (1 + 2 + 4 + 2 * LATENCY_HIST_BUCKETS) // id, count, max_ms (uint32), buckets
+
+void latency_hist_init(latency_hist_t *hist, const char *name);
+void latency_hist_reset(latency_hist_t *hist);
+void latency_hist_record(latency_hist_t *hist, clock_time_t elapsed);
+uint32_t latency_hist_percentile(const latency_hist_t *hist, uint8_t percent);
+void latency_hist_log(const latency_hist_t *hist);
+
+/* Returns 1 if the datagram is a histogram dump request */
+uint8_t latency_is_request(const uint8_t *data, uint16_t datalen);
+
+/* Serialize a set of histograms; returns frame length or 0 if buf is too small */
+uint16_t latency_frame_build(uint8_t node_type, const latency_hist_t *const *hists,
+                             uint8_t num_hists, uint8_t *buf, uint16_t buf_len);
+
+#endif /* LATENCY_HISTOGRAM_H_ */
@@ -0,0 +1,341 @@
+#include "contiki.h"
+#include "random.h"
+#include "project-conf.h"
+#include "energy-kernel.h"
+#include "coverage-raster.h"
+#include "sys/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define LOG_MODULE "Lifetime"
+#define LOG_LEVEL LOG_LEVEL_APP
+
+/* Native long-horizon lifetime simulation. A deployment outcome (sensor
+   positions, robot-deployed flag, robot-in-range flag) is loaded from
+   $LIFETIME_DEPLOYMENT or generated, and the steady-state duty cycle of
+   sensor-node.c is integrated with the batched energy kernel. Time jumps
+   from one event (a battery running out or a curve sample) to the next
+   instead of stepping through the 10 s mode_timer and 30 s sensing_timer. */
+
+/* One accounting cycle is two sensing periods. Robot-deployed sensors are
+   always active and sense in both. Randomly deployed sensors toggle mode with
+   the same probability either way, so they are active half the time in
+   steady state and sense once per cycle on average. Sensors that answered an
+   Mp (robot_in_range) also send a status update after each sensing. */
+#define CYCLE_SECONDS (2 * MESSAGE_SEND_INTERVAL / CLOCK_SECOND)
+#define SAMPLE_CYCLES (LIFETIME_SAMPLE_INTERVAL / CYCLE_SECONDS)
+#define HORIZON_CYCLES ((uint32_t)LIFETIME_MAX_DAYS * 86400 / CYCLE_SECONDS)
+
+/* Grid layout of the BS LA_DB: NO_G grids per LA, at most MAX_LOCATION_AREAS LAs */
+#define GRID_SIDE (ROBOT_PERCEPTION_RANGE / SENSOR_PERCEPTION_RANGE)
+#define GRIDS_PER_LA (GRID_SIDE * GRID_SIDE)
+#define LAS_X (TARGET_AREA_WIDTH / ROBOT_PERCEPTION_RANGE)
+#define LAS_Y (TARGET_AREA_HEIGHT / ROBOT_PERCEPTION_RANGE)
+#define NUM_LAS (LAS_X * LAS_Y < MAX_LOCATION_AREAS ? LAS_X * LAS_Y : MAX_LOCATION_AREAS)
+#define TOTAL_GRIDS (NUM_LAS * GRIDS_PER_LA)
+#define NO_GRID (-1)
+
+#define NOT_REACHED UINT32_MAX
+
+/* Geometric coverage raster over the whole target area */
+#define RASTER_WIDTH (TARGET_AREA_WIDTH / COVERAGE_RASTER_CELL)
+#define RASTER_HEIGHT (TARGET_AREA_HEIGHT / COVERAGE_RASTER_CELL)
+
+/* Kernel state, one entry per sensor */
+static uint32_t sensing_ops[LIFETIME_MAX_SENSORS];
+static uint32_t processing_ops[LIFETIME_MAX_SENSORS];
+static uint32_t tx_ops[LIFETIME_MAX_SENSORS];
+static uint32_t rx_ops[LIFETIME_MAX_SENSORS];
+static uint8_t active[LIFETIME_MAX_SENSORS];
+static float baseline_energy[LIFETIME_MAX_SENSORS];
+static float sensing_energy[LIFETIME_MAX_SENSORS];
+static float processing_energy[LIFETIME_MAX_SENSORS];
+static float radio_energy[LIFETIME_MAX_SENSORS];
+static float total_energy[LIFETIME_MAX_SENSORS];
+static float residual_energy[LIFETIME_MAX_SENSORS];
+
+static energy_soa_t soa = {
+    LIFETIME_MAX_SENSORS,
+    sensing_ops, processing_ops, tx_ops, rx_ops, active,
+    baseline_energy, sensing_energy, processing_energy, radio_energy,
+    total_energy, residual_energy
+};
+
+static uint64_t raster_bits[COVERAGE_RASTER_WORDS(RASTER_WIDTH, RASTER_HEIGHT,
+                                                   COVERAGE_RASTER_LEVELS)];
+static coverage_raster_t raster;
+
+/* Deployment outcome and simulation progress */
+static struct {
+    uint32_t num_sensors;
+    uint32_t dropped_sensors;     // Beyond LIFETIME_MAX_SENSORS
+    
+    /* Per sensor */
+    uint16_t x[LIFETIME_MAX_SENSORS];
+    uint16_t y[LIFETIME_MAX_SENSORS];
+    uint8_t cycle_sensing[LIFETIME_MAX_SENSORS];   // Sensing (and processing) ops per cycle
+    uint8_t cycle_tx[LIFETIME_MAX_SENSORS];        // Status updates per cycle
+    float cycle_energy[LIFETIME_MAX_SENSORS];      // J drawn per cycle, for event planning
+    int16_t grid[LIFETIME_MAX_SENSORS];            // Grid index or NO_GRID
+    uint8_t alive[LIFETIME_MAX_SENSORS];
+    
+    /* Coverage: live sensors per grid */
+    uint16_t grid_sensors[TOTAL_GRIDS];
+    uint16_t covered_grids;
+    uint32_t alive_sensors;
+    
+    /* Events, in cycles */
+    uint32_t cycle;
+    uint32_t first_death;
+    uint32_t coverage_loss;
+    uint32_t last_death;
+} lifetime;
+
+PROCESS(lifetime_sim_process, "Lifetime Simulation");
+AUTOSTART_PROCESSES(&lifetime_sim_process);
+
+/* Deployment */
+static int16_t grid_of(uint16_t x, uint16_t y) {
+    uint16_t la_x = x / ROBOT_PERCEPTION_RANGE;
+    uint16_t la_y = y / ROBOT_PERCEPTION_RANGE;
+    uint16_t grid_x = (x % ROBOT_PERCEPTION_RANGE) / SENSOR_PERCEPTION_RANGE;
+    uint16_t grid_y = (y % ROBOT_PERCEPTION_RANGE) / SENSOR_PERCEPTION_RANGE;
+    uint16_t la;
+    
+    if (la_x >= LAS_X || la_y >= LAS_Y || grid_x >= GRID_SIDE || grid_y >= GRID_SIDE) {
+        return NO_GRID;
+    }
+    la = la_y * LAS_X + la_x;
+    if (la >= NUM_LAS) {
+        return NO_GRID;
+    }
+    return la * GRIDS_PER_LA + grid_y * GRID_SIDE + grid_x;
+}
+
+static void add_sensor(uint16_t x, uint16_t y, uint8_t robot_deployed,
+                       uint8_t robot_in_range) {
+    uint32_t i = lifetime.num_sensors;
+    
+    if (i >= LIFETIME_MAX_SENSORS) {
+        lifetime.dropped_sensors++;
+        return;
+    }
+    lifetime.num_sensors++;
+    
+    lifetime.x[i] = x;
+    lifetime.y[i] = y;
+    lifetime.cycle_sensing[i] = robot_deployed ? 2 : 1;
+    lifetime.cycle_tx[i] = robot_in_range ? lifetime.cycle_sensing[i] : 0;
+    lifetime.cycle_energy[i] = energy_sensor_baseline(CYCLE_SECONDS) +
+                               energy_sensor_sensing(lifetime.cycle_sensing[i]) +
+                               energy_sensor_processing(lifetime.cycle_sensing[i],
+                                                        ENERGY_AVG_OP_TIME) +
+                               energy_sensor_radio(lifetime.cycle_tx[i], 0,
+                                                   ENERGY_AVG_OP_TIME, ENERGY_AVG_OP_TIME);
+    lifetime.grid[i] = grid_of(x, y);
+    lifetime.alive[i] = 1;
+    lifetime.alive_sensors++;
+    
+    /* Every term an idle sensor would leave out of E_idle is zero while it is
+       idle, so E_active is the energy drawn from the battery in both modes */
+    active[i] = 1;
+    residual_energy[i] = (float)SENSOR_BATTERY_CAPACITY;
+    
+    if (lifetime.grid[i] != NO_GRID && lifetime.grid_sensors[lifetime.grid[i]]++ == 0) {
+        lifetime.covered_grids++;
+    }
+}
+
+static void load_deployment(const char *path) {
+    FILE *file = fopen(path, "r");
+    char line[128];
+    unsigned id, x, y, robot_deployed, robot_in_range;
+    
+    if (file == NULL) {
+        LOG_ERR("Cannot open deployment %s\n", path);
+        exit(1);
+    }
+    
+    /* id,x,y,robot_deployed,robot_in_range; other lines (the header) are skipped */
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%u,%u,%u,%u,%u", &id, &x, &y, &robot_deployed, &robot_in_range) == 5) {
+            add_sensor(x, y, robot_deployed != 0, robot_in_range != 0);
+        }
+    }
+    fclose(file);
+    LOG_INFO("Loaded %lu sensors from %s\n", (unsigned long)lifetime.num_sensors, path);
+}
+
+static void generate_deployment() {
+    /* Complete APP_I outcome: a robot-deployed sensor at every grid centre */
+    for (uint16_t la = 0; la < NUM_LAS; la++) {
+        uint16_t origin_x = (la % LAS_X) * ROBOT_PERCEPTION_RANGE;
+        uint16_t origin_y = (la / LAS_X) * ROBOT_PERCEPTION_RANGE;
+        
+        for (uint16_t g = 0; g < GRIDS_PER_LA; g++) {
+            add_sensor(origin_x + (g % GRID_SIDE) * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2,
+                       origin_y + (g / GRID_SIDE) * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2,
+                       1, 1);
+        }
+    }
+    
+    /* Plus the random sensors left in the field */
+    for (uint16_t i = 0; i < LIFETIME_RANDOM_SENSORS; i++) {
+        add_sensor(random_rand() % TARGET_AREA_WIDTH, random_rand() % TARGET_AREA_HEIGHT,
+                   0, 0);
+    }
+    LOG_INFO("Generated %lu sensors (%u robot-deployed)\n",
+             (unsigned long)lifetime.num_sensors, (unsigned)TOTAL_GRIDS);
+}
+
+/* Event loop */
+static float per_ac() {
+    return TOTAL_GRIDS > 0 ? ((float)lifetime.covered_grids / TOTAL_GRIDS) * 100.0 : 0.0;
+}
+
+/* Rasterize the sensing discs of the live sensors */
+static void evaluate_area_coverage() {
+    coverage_raster_clear(&raster);
+    for (uint32_t i = 0; i < lifetime.num_sensors; i++) {
+        if (lifetime.alive[i]) {
+            coverage_raster_add_disc(&raster, lifetime.x[i], lifetime.y[i], SENSOR_PERCEPTION_RANGE);
+        }
+    }
+}
+
+static void print_curve_point() {
+    evaluate_area_coverage();
+    LOG_INFO("LIFETIME_CURVE, %lu, %lu, %u, %.4f, %.4f, %.4f\n",
+             (unsigned long)lifetime.cycle * CYCLE_SECONDS,
+             (unsigned long)lifetime.alive_sensors, lifetime.covered_grids, per_ac(),
+             coverage_raster_percentage(&raster, 1),
+             coverage_raster_percentage(&raster, COVERAGE_RASTER_LEVELS));
+}
+
+/* Cycles until the next sample point or battery depletion, whichever is first */
+static uint32_t cycles_to_next_event() {
+    uint32_t cycles = SAMPLE_CYCLES - lifetime.cycle % SAMPLE_CYCLES;
+    
+    for (uint32_t i = 0; i < lifetime.num_sensors; i++) {
+        if (lifetime.alive[i]) {
+            uint32_t left = (uint32_t)ceil((double)residual_energy[i] / lifetime.cycle_energy[i]);
+            if (left < cycles) {
+                cycles = left > 0 ? left : 1;
+            }
+        }
+    }
+    if (cycles > HORIZON_CYCLES - lifetime.cycle) {
+        cycles = HORIZON_CYCLES - lifetime.cycle;
+    }
+    return cycles;
+}
+
+static void advance(uint32_t cycles) {
+    for (uint32_t i = 0; i < lifetime.num_sensors; i++) {
+        uint32_t ops = lifetime.alive[i] ? cycles * lifetime.cycle_sensing[i] : 0;
+        sensing_ops[i] = ops;
+        processing_ops[i] = ops;
+        tx_ops[i] = lifetime.alive[i] ? cycles * lifetime.cycle_tx[i] : 0;
+        rx_ops[i] = 0;
+    }
+    energy_kernel_step(&soa, 0, lifetime.num_sensors, (float)cycles * CYCLE_SECONDS);
+    lifetime.cycle += cycles;
+}
+
+static uint32_t collect_deaths() {
+    uint32_t deaths = 0;
+    
+    for (uint32_t i = 0; i < lifetime.num_sensors; i++) {
+        if (lifetime.alive[i] && residual_energy[i] <= 0.0f) {
+            lifetime.alive[i] = 0;
+            lifetime.alive_sensors--;
+            deaths++;
+            if (lifetime.grid[i] != NO_GRID && --lifetime.grid_sensors[lifetime.grid[i]] == 0) {
+                lifetime.covered_grids--;
+            }
+        }
+    }
+    
+    if (deaths > 0) {
+        if (lifetime.first_death == NOT_REACHED) {
+            lifetime.first_death = lifetime.cycle;
+        }
+        lifetime.last_death = lifetime.cycle;
+    }
+    return deaths;
+}
+
+static void check_coverage_loss() {
+    if (lifetime.coverage_loss == NOT_REACHED && per_ac() < LIFETIME_COVERAGE_THRESHOLD) {
+        lifetime.coverage_loss = lifetime.cycle;
+    }
+}
+
+static long event_seconds(uint32_t cycle) {
+    return cycle == NOT_REACHED ? -1 : (long)cycle * CYCLE_SECONDS;
+}
+
+static void print_lifetime_report() {
+    LOG_INFO("=== LIFETIME REPORT ===\n");
+    LOG_INFO("Sensors: %lu (%lu dropped), grids: %u\n", (unsigned long)lifetime.num_sensors,
+             (unsigned long)lifetime.dropped_sensors, (unsigned)TOTAL_GRIDS);
+    LOG_INFO("First death: %.2f days\n", event_seconds(lifetime.first_death) / 86400.0);
+    LOG_INFO("Per_AC below %.1f%%: %.2f days\n", (double)LIFETIME_COVERAGE_THRESHOLD,
+             event_seconds(lifetime.coverage_loss) / 86400.0);
+    LOG_INFO("Last death: %.2f days\n", event_seconds(lifetime.last_death) / 86400.0);
+    LOG_INFO("Alive at end: %lu, Per_AC: %.2f%%\n", (unsigned long)lifetime.alive_sensors, per_ac());
+    
+    /* Event times in seconds, -1 if not reached within LIFETIME_MAX_DAYS */
+    LOG_INFO("LIFETIME_RESULT, %lu, %ld, %ld, %ld, %lu, %.4f\n",
+             (unsigned long)lifetime.num_sensors, event_seconds(lifetime.first_death),
+             event_seconds(lifetime.coverage_loss), event_seconds(lifetime.last_death),
+             (unsigned long)lifetime.alive_sensors, per_ac());
+    LOG_INFO("========================\n");
+}
+
+PROCESS_THREAD(lifetime_sim_process, ev, data) {
+    const char *path;
+    const char *seed;
+    uint32_t deaths;
+    
+    PROCESS_BEGIN();
+    
+    lifetime.first_death = NOT_REACHED;
+    lifetime.coverage_loss = NOT_REACHED;
+    lifetime.last_death = NOT_REACHED;
+    
+    seed = getenv("LIFETIME_SEED");
+    if (seed != NULL) {
+        random_init((unsigned short)atoi(seed));
+    }
+    path = getenv("LIFETIME_DEPLOYMENT");
+    if (path != NULL) {
+        load_deployment(path);
+    } else {
+        generate_deployment();
+    }
+    soa.capacity = lifetime.num_sensors;
+    coverage_raster_init(&raster, raster_bits, RASTER_WIDTH, RASTER_HEIGHT,
+                         COVERAGE_RASTER_LEVELS, COVERAGE_RASTER_CELL);
+    
+    print_curve_point();
+    check_coverage_loss();
+    
+    while (lifetime.alive_sensors > 0 && lifetime.cycle < HORIZON_CYCLES) {
+        advance(cycles_to_next_event());
+        deaths = collect_deaths();
+        if (deaths > 0) {
+            check_coverage_loss();
+        }
+        if (deaths > 0 || lifetime.cycle % SAMPLE_CYCLES == 0) {
+            print_curve_point();
+        }
+    }
+    
+    print_lifetime_report();
+    exit(0);
+    
+    PROCESS_END();
+}
@@ -0,0 +1,122 @@
+#include "log-queue.h"
+#include "node-shell.h"
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE log_queue_module
+#define LOG_LEVEL app_log_level
+
+typedef struct {
+    uint8_t type;
+    uint16_t args[LOG_QUEUE_MAX_ARGS];
+} log_event_t;
+
+/* Per-type rate limiting window and counters */
+typedef struct {
+    clock_time_t window_start;
+    uint8_t window_count;
+    uint32_t posted;
+    uint32_t dropped;
+} log_type_state_t;
+
+static const char *log_queue_module = "LogQueue";
+static const log_event_desc_t *event_descs;
+static uint8_t num_event_types;
+static log_type_state_t type_state[LOG_QUEUE_MAX_TYPES];
+
+static log_event_t events[LOG_QUEUE_SIZE];
+static uint8_t queue_head;   // Next event to print
+static uint8_t queue_len;
+
+PROCESS(log_queue_process, "Deferred Log Process");
+
+void log_queue_init(const char *module, const log_event_desc_t *descs, uint8_t num_types) {
+    log_queue_module = module;
+    event_descs = descs;
+    num_event_types = num_types < LOG_QUEUE_MAX_TYPES ? num_types : LOG_QUEUE_MAX_TYPES;
+    memset(type_state, 0, sizeof(type_state));
+    queue_head = 0;
+    queue_len = 0;
+    process_start(&log_queue_process, NULL);
+}
+
+void log_queue_post(uint8_t type, uint16_t a, uint16_t b, uint16_t c, uint16_t d) {
+    if (type >= num_event_types || event_descs[type].level > app_log_level) {
+        return;
+    }
+    
+    log_type_state_t *state = &type_state[type];
+    clock_time_t now = clock_time();
+    state->posted++;
+    
+    if (now - state->window_start >= LOG_QUEUE_RATE_WINDOW) {
+        state->window_start = now;
+        state->window_count = 0;
+    }
+    if (state->window_count >= LOG_QUEUE_RATE_LIMIT || queue_len >= LOG_QUEUE_SIZE) {
+        state->dropped++;
+        return;
+    }
+    state->window_count++;
+    
+    log_event_t *event = &events[(queue_head + queue_len) % LOG_QUEUE_SIZE];
+    event->type = type;
+    event->args[0] = a;
+    event->args[1] = b;
+    event->args[2] = c;
+    event->args[3] = d;
+    queue_len++;
+    
+    process_poll(&log_queue_process);
+}
+
+uint8_t log_queue_num_types(void) {
+    return num_event_types;
+}
+
+uint32_t log_queue_posted(uint8_t type) {
+    return type < num_event_types ? type_state[type].posted : 0;
+}
+
+uint32_t log_queue_dropped(uint8_t type) {
+    return type < num_event_types ? type_state[type].dropped : 0;
+}
+
+void log_queue_log_stats(void) {
+    for (uint8_t i = 0; i < num_event_types; i++) {
+        if (type_state[i].dropped > 0) {
+            LOG_INFO("Log event %u: %lu posted, %lu dropped\n", i,
+                     (unsigned long)type_state[i].posted, (unsigned long)type_state[i].dropped);
+        }
+    }
+}
+
+static void log_queue_print(const log_event_t *event) {
+    const log_event_desc_t *desc = &event_descs[event->type];
+    
+    if (desc->level <= LOG_LEVEL_WARN) {
+        LOG_WARN(desc->fmt, event->args[0], event->args[1], event->args[2], event->args[3]);
+    } else {
+        LOG_INFO(desc->fmt, event->args[0], event->args[1], event->args[2], event->args[3]);
+    }
+}
+
+PROCESS_THREAD(log_queue_process, ev, data) {
+    PROCESS_BEGIN();
+    
+    while(1) {
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+        
+        /* Print a bounded batch, then yield so other processes get the CPU */
+        for (uint8_t i = 0; i < LOG_QUEUE_DRAIN_BATCH && queue_len > 0; i++) {
+            log_queue_print(&events[queue_head]);
+            queue_head = (queue_head + 1) % LOG_QUEUE_SIZE;
+            queue_len--;
+        }
+        if (queue_len > 0) {
+            process_poll(&log_queue_process);
+        }
+    }
+    
+    PROCESS_END();
+}
@@ -0,0 +1,31 @@
+#ifndef LOG_QUEUE_H_
+#define LOG_QUEUE_H_
+
+#include "contiki.h"
+#include "project-conf.h"
+#include <stdint.h>
+
+/* Deferred logging: radio callbacks post compact events, a polled process
+   formats and prints them later. Each event type is rate limited and keeps
+   a drop counter. */
+
+#define LOG_QUEUE_MAX_ARGS 4
+
+/* Per-type descriptor: printf format taking up to LOG_QUEUE_MAX_ARGS %u
+   arguments, and the log level it is printed at */
+typedef struct {
+    const char *fmt;
+    uint8_t level;
+} log_event_desc_t;
+
+void log_queue_init(const char *module, const log_event_desc_t *descs, uint8_t num_types);
+void log_queue_post(uint8_t type, uint16_t a, uint16_t b, uint16_t c, uint16_t d);
+
+uint8_t log_queue_num_types(void);
+uint32_t log_queue_posted(uint8_t type);
+uint32_t log_queue_dropped(uint8_t type);
+
+/* Log the per-type posted/dropped counters */
+void log_queue_log_stats(void);
+
+#endif /* LOG_QUEUE_H_ */
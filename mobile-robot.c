@@ -5,14 +5,26 @@
 #include "sys/etimer.h"
 #include "sys/clock.h"
 #include "random.h"
+#include "cfs/cfs.h"
+#include "lib/memb.h"
+#include "lib/list.h"
 #include "project-conf.h"
+#include "latency-histogram.h"
+#include "profile-scope.h"
+#include "node-shell.h"
+#include "radio-trace.h"
+#include "log-queue.h"
+#include "coverage-raster.h"
+#include "obstacle-map.h"
+#include "path-planner.h"
+#include "sensor-command.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
 #include "sys/log.h"
 #define LOG_MODULE "MobileRobot"
-#define LOG_LEVEL LOG_LEVEL_APP
+#define LOG_LEVEL app_log_level
 
 /* Robot operational phases */
 typedef enum {
@@ -46,20 +58,105 @@ typedef struct {
     uint8_t covered_grids;
 } robot_report_msg_t;
 
-/* Grid and Sensor Database Records */
+/* Sleep rotation for a sensor whose area awake sensors already k-cover */
+#define SLEEP_MSG_MAGIC0 'S'
+#define SLEEP_MSG_MAGIC1 'R'
 typedef struct {
-    uint8_t grid_id;
-    uint16_t center_x;
-    uint16_t center_y;
-    uint8_t grid_status; // 0 = uncovered, 1 = covered
-} grid_db_record_t;
+    uint8_t magic[2];
+    uint8_t sensor_id;
+    uint8_t slot;         // Awake in this slot of the rotation
+    uint8_t num_slots;
+} sleep_schedule_msg_t;
+
+/* Robot_RM: sent after a reboot when the robot resumes a journaled local phase */
+typedef struct {
+    uint8_t robot_id;
+    uint8_t la_id;
+    uint8_t next_grid;
+    uint8_t covered_grids;
+} robot_resume_msg_t;
 
+/* BS acknowledgement of Robot_RM, carrying the LA the BS now has on record */
+#define RESUME_ACK_MAGIC0 'R'
+#define RESUME_ACK_MAGIC1 'A'
 typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t la_id;
+} robot_resume_ack_msg_t;
+
+/* Grid and Sensor Databases, stored as packed struct-of-arrays.
+   Coordinates are offsets from the LA origin, so they fit in 8 bits while
+   the LA side (ROBOT_PERCEPTION_RANGE) does; status flags live in bitmaps.
+   grid_id is implicit (index + 1). */
+#if ROBOT_PERCEPTION_RANGE <= 255
+typedef uint8_t la_coord_t;
+#else
+typedef uint16_t la_coord_t;
+#endif
+
+#define DB_BITMAP_BYTES(n) (((n) + 7) / 8)
+
+typedef struct {
+    la_coord_t center_x[MAX_SENSORS_PER_AREA];
+    la_coord_t center_y[MAX_SENSORS_PER_AREA];
+    uint8_t covered[DB_BITMAP_BYTES(MAX_SENSORS_PER_AREA)]; // grid_status: 0 = uncovered, 1 = covered
+    uint8_t no_deploy[DB_BITMAP_BYTES(MAX_SENSORS_PER_AREA)]; // Centre blocked or unreachable: skipped
+} grid_db_t;
+
+typedef struct {
+    uint8_t sensor_id[MAX_SENSORS_PER_AREA];
+    la_coord_t x_coord[MAX_SENSORS_PER_AREA];
+    la_coord_t y_coord[MAX_SENSORS_PER_AREA];
+    uint8_t active[DB_BITMAP_BYTES(MAX_SENSORS_PER_AREA)];    // sensor_status 1
+    uint8_t collected[DB_BITMAP_BYTES(MAX_SENSORS_PER_AREA)]; // sensor_status 2
+} sensor_db_t;
+
+/* Second-tier Sensor_DB record for sensors discovered after the hot array is
+   full: only the id and the grid it lies in, allocated from a memb pool */
+typedef struct sensor_spill {
+    struct sensor_spill *next;
     uint8_t sensor_id;
-    uint16_t x_coord;
-    uint16_t y_coord;
-    uint8_t sensor_status; // 0 = idle, 1 = active
-} sensor_db_record_t;
+    uint8_t grid_index;
+} sensor_spill_t;
+
+#define SPILLED_SENSOR_INDEX 0xFF
+
+/* Local-phase journal: a header per LA followed by fixed-size records.
+   DISPERSION and GRID records are commit points; anything after the last
+   commit is discarded on replay. */
+#define JOURNAL_FILE "robot-journal"
+#define JOURNAL_MAGIC 0x4B             // Bumped when the header layout changes
+#define JOURNAL_BATCH 8
+
+typedef enum {
+    JOURNAL_REC_SENSOR = 1,      // index = slot, a = x, b = y, c = sensor_id | status << 8
+    JOURNAL_REC_DISPERSION = 2,  // a = num_sensors, b = stock, c = no_p
+    JOURNAL_REC_GRID = 3,        // index = grid, a = stock, b = no_p, c = grid_status
+    JOURNAL_REC_SPILL = 4,       // index = grid, a = sensor_id
+    JOURNAL_REC_UNSPILL = 5,     // a = sensor_id
+    JOURNAL_REC_STOCK = 6        // index = num_stock_ids after the change, a = sensor_id pushed (0 on a pop)
+} journal_record_type_t;
+
+typedef struct {
+    uint8_t magic;
+    uint8_t robot_id;
+    uint8_t la_id;
+    uint8_t stock_rs;
+    uint16_t la_center_x;
+    uint16_t la_center_y;
+    uip_ipaddr_t base_station_addr;
+    uint8_t num_stock_ids;                   // Collected sensors in stock when the LA started
+    uint8_t stock_ids[ROBOT_STOCK_CAPACITY];
+} journal_header_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t index;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+} journal_record_t;
 
 /* Mobile Robot State */
 static struct {
@@ -72,15 +169,23 @@ static struct {
     uint8_t assigned_la_id;
     uint16_t la_center_x;
     uint16_t la_center_y;
+    uint16_t la_origin_x;
+    uint16_t la_origin_y;
+    obstacle_la_map_t obstacle_map; // Latest map from the BS; used while its la_id is assigned_la_id
     
     /* Local databases */
-    grid_db_record_t grid_db[MAX_SENSORS_PER_AREA];
-    sensor_db_record_t sensor_db[MAX_SENSORS_PER_AREA];
+    grid_db_t grid_db;
+    sensor_db_t sensor_db;
     uint8_t num_grids;
     uint8_t num_sensors;
+    uint8_t grid_size;       // Grids per LA side
+    uint8_t num_spilled;     // Sensors held in the overflow tier
+    uint16_t spill_dropped;  // Sensors lost because the overflow pool was exhausted
     
     /* Robot stock and movement */
     uint8_t stock_rs; // Current sensor stock
+    uint8_t stock_ids[ROBOT_STOCK_CAPACITY]; // Collected sensor nodes in stock, last collected on top
+    uint8_t num_stock_ids;                   // Stock beyond these is not backed by a sensor node
     uint8_t no_p;     // Number of permissible moves
     uint8_t current_grid_index;
     
@@ -90,27 +195,82 @@ static struct {
     float radio_energy;
     float mobility_energy;
     float total_distance_moved;
+    float cumulative_distance;  // D_p, never reset
     
     /* Operation counters */
     uint32_t tx_operations;
     uint32_t rx_operations;
     uint32_t movement_operations;
     uint32_t processing_operations;
+    uint32_t total_tx_operations;  // Never reset, for conformance checks
+    uint32_t total_rx_operations;
     
     /* Timing */
     clock_time_t start_time;
     clock_time_t last_energy_calc;
     clock_time_t phase_start_time;
+    clock_time_t mp_sent_time;        // Last Mp broadcast
+    clock_time_t command_sent_time;   // Last grid command frame, 0 once acked
+    clock_time_t report_sent_time;    // Last Robot_pM, 0 once the next assignment arrives
     
     /* Communication */
     uip_ipaddr_t base_station_addr;
     uint8_t bs_reachable;
+    uint8_t resume_pending;  // Robot_RM not yet acknowledged by the BS
+    
+    /* Grid command frame of the current grid and the acks gathered for it */
+    sensor_cmd_frame_t command;
+    uint8_t command_acked[SENSOR_CMD_BITMAP_BYTES];
+    uint8_t command_seqno;
+    uint8_t command_retries;
 } mobile_robot;
 
 static struct simple_udp_connection udp_conn;
 static struct etimer phase_timer;
 static struct etimer energy_timer;
 static struct etimer discovery_timer;
+static struct etimer command_timer;
+static struct etimer resume_timer;
+
+/* Latency histograms */
+static latency_hist_t hist_mp_reply;        // Mp broadcast -> Sensor_M
+static latency_hist_t hist_deploy_confirm;  // Grid command frame -> first sensor ack
+static latency_hist_t hist_report_assign;   // Robot_pM -> next LA assignment
+static latency_hist_t hist_discovery;       // Topology discovery phase duration
+static latency_hist_t hist_dispersion;      // Dispersion phase duration
+static const latency_hist_t *const robot_hists[] = {
+    &hist_mp_reply, &hist_deploy_confirm, &hist_report_assign, &hist_discovery, &hist_dispersion
+};
+#define ROBOT_NUM_HISTS (sizeof(robot_hists) / sizeof(robot_hists[0]))
+static uint8_t latency_frame[LATENCY_FRAME_HEADER_LEN + ROBOT_NUM_HISTS * LATENCY_FRAME_ENTRY_LEN];
+
+/* Deferred log events posted from the radio callback path */
+enum {
+    ROBOT_LOG_ASSIGNMENT,
+    ROBOT_LOG_SENSOR_FOUND,
+    ROBOT_LOG_SENSOR_SPILLED,
+    ROBOT_LOG_SENSOR_DROPPED,
+    ROBOT_LOG_SENSOR_OUTSIDE,
+    ROBOT_LOG_NUM_EVENTS
+};
+
+static const log_event_desc_t robot_log_events[ROBOT_LOG_NUM_EVENTS] = {
+    [ROBOT_LOG_ASSIGNMENT] = { "Received LA assignment: LA %u at (%u, %u)\n", LOG_LEVEL_INFO },
+    [ROBOT_LOG_SENSOR_FOUND] = { "Discovered sensor %u at (%u, %u), status: %u\n", LOG_LEVEL_INFO },
+    [ROBOT_LOG_SENSOR_SPILLED] = { "Discovered sensor %u in grid %u, spilled to overflow tier\n", LOG_LEVEL_INFO },
+    [ROBOT_LOG_SENSOR_DROPPED] = { "Sensor %u dropped: overflow pool exhausted (%u dropped)\n", LOG_LEVEL_WARN },
+    [ROBOT_LOG_SENSOR_OUTSIDE] = { "Sensor %u at (%u, %u) outside LA %u boundaries - ignored\n", LOG_LEVEL_INFO },
+};
+
+/* Profiling scopes */
+static profile_scope_t prof_init_grid = PROFILE_SCOPE_INIT("initialize_grid_db");
+static profile_scope_t prof_discovery = PROFILE_SCOPE_INIT("discovery_reply");
+static profile_scope_t prof_grid = PROFILE_SCOPE_INIT("process_grid_deployment");
+static profile_scope_t prof_udp_rx = PROFILE_SCOPE_INIT("udp_rx_callback");
+static profile_scope_t *const robot_scopes[] = { &prof_init_grid, &prof_discovery, &prof_grid, &prof_udp_rx };
+
+MEMB(sensor_spill_memb, sensor_spill_t, SENSOR_SPILL_POOL_SIZE);
+LIST(sensor_spill_list);
 
 PROCESS(mobile_robot_process, "Mobile Robot Process");
 AUTOSTART_PROCESSES(&mobile_robot_process);
@@ -118,7 +278,6 @@ AUTOSTART_PROCESSES(&mobile_robot_process);
 /* Forward declarations */
 static float calculate_distance(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 static int8_t find_nearest_sensor_to_grid(uint8_t grid_index);
-static void deploy_or_relocate_sensor_to_grid(uint8_t sensor_index, uint8_t grid_index, uint8_t deploy_from_stock);
 static void move_robot(uint16_t target_x, uint16_t target_y);
 
 /* Energy Calculation Functions */
@@ -161,11 +320,152 @@ static void update_energy_consumption() {
     mobile_robot.last_energy_calc = current_time;
     
     /* Reset counters */
+    mobile_robot.total_tx_operations += mobile_robot.tx_operations;
+    mobile_robot.total_rx_operations += mobile_robot.rx_operations;
+    mobile_robot.cumulative_distance += mobile_robot.total_distance_moved;
     mobile_robot.tx_operations = 0;
     mobile_robot.rx_operations = 0;
     mobile_robot.total_distance_moved = 0;
 }
 
+/* Database Accessors */
+static inline uint8_t db_bit_get(const uint8_t *bitmap, uint8_t index) {
+    return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline void db_bit_put(uint8_t *bitmap, uint8_t index, uint8_t value) {
+    if (value) {
+        bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+    } else {
+        bitmap[index >> 3] &= (uint8_t)~(1 << (index & 7));
+    }
+}
+
+static inline uint16_t grid_center_x(uint8_t grid_index) {
+    return mobile_robot.la_origin_x + mobile_robot.grid_db.center_x[grid_index];
+}
+
+static inline uint16_t grid_center_y(uint8_t grid_index) {
+    return mobile_robot.la_origin_y + mobile_robot.grid_db.center_y[grid_index];
+}
+
+static inline uint8_t grid_status(uint8_t grid_index) {
+    return db_bit_get(mobile_robot.grid_db.covered, grid_index);
+}
+
+static inline void grid_set_status(uint8_t grid_index, uint8_t status) {
+    db_bit_put(mobile_robot.grid_db.covered, grid_index, status);
+}
+
+static inline uint8_t grid_deployable(uint8_t grid_index) {
+    return !db_bit_get(mobile_robot.grid_db.no_deploy, grid_index);
+}
+
+static inline uint16_t sensor_x(uint8_t sensor_index) {
+    return mobile_robot.la_origin_x + mobile_robot.sensor_db.x_coord[sensor_index];
+}
+
+static inline uint16_t sensor_y(uint8_t sensor_index) {
+    return mobile_robot.la_origin_y + mobile_robot.sensor_db.y_coord[sensor_index];
+}
+
+/* 0 = idle, 1 = active, 2 = collected */
+static inline uint8_t sensor_status(uint8_t sensor_index) {
+    if (db_bit_get(mobile_robot.sensor_db.collected, sensor_index)) {
+        return 2;
+    }
+    return db_bit_get(mobile_robot.sensor_db.active, sensor_index);
+}
+
+static inline void sensor_set_status(uint8_t sensor_index, uint8_t status) {
+    db_bit_put(mobile_robot.sensor_db.active, sensor_index, status == 1);
+    db_bit_put(mobile_robot.sensor_db.collected, sensor_index, status == 2);
+}
+
+static void sensor_db_store(uint8_t sensor_index, uint8_t sensor_id,
+                            uint16_t x_coord, uint16_t y_coord, uint8_t status) {
+    mobile_robot.sensor_db.sensor_id[sensor_index] = sensor_id;
+    mobile_robot.sensor_db.x_coord[sensor_index] = x_coord - mobile_robot.la_origin_x;
+    mobile_robot.sensor_db.y_coord[sensor_index] = y_coord - mobile_robot.la_origin_y;
+    sensor_set_status(sensor_index, status);
+}
+
+/* Grid containing an absolute position inside the current LA */
+static uint8_t grid_index_at(uint16_t x, uint16_t y) {
+    uint8_t gx = (x - mobile_robot.la_origin_x) / SENSOR_PERCEPTION_RANGE;
+    uint8_t gy = (y - mobile_robot.la_origin_y) / SENSOR_PERCEPTION_RANGE;
+    uint8_t index;
+    
+    if (gx >= mobile_robot.grid_size) {
+        gx = mobile_robot.grid_size - 1;
+    }
+    if (gy >= mobile_robot.grid_size) {
+        gy = mobile_robot.grid_size - 1;
+    }
+    index = gy * mobile_robot.grid_size + gx;
+    return (index < mobile_robot.num_grids) ? index : mobile_robot.num_grids - 1;
+}
+
+/* Overflow tier operations */
+static uint8_t sensor_spill_add(uint8_t sensor_id, uint8_t grid_index) {
+    sensor_spill_t *spill = memb_alloc(&sensor_spill_memb);
+    
+    if (spill == NULL) {
+        mobile_robot.spill_dropped++;
+        return 0;
+    }
+    spill->sensor_id = sensor_id;
+    spill->grid_index = grid_index;
+    list_add(sensor_spill_list, spill);
+    mobile_robot.num_spilled++;
+    return 1;
+}
+
+static uint8_t sensor_spill_count(uint8_t grid_index) {
+    uint8_t count = 0;
+    for (sensor_spill_t *spill = list_head(sensor_spill_list); spill != NULL; spill = spill->next) {
+        if (spill->grid_index == grid_index) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void sensor_spill_release(sensor_spill_t *spill) {
+    list_remove(sensor_spill_list, spill);
+    memb_free(&sensor_spill_memb, spill);
+    mobile_robot.num_spilled--;
+}
+
+/* Remove one spilled sensor from a grid; returns its id or -1 if none */
+static int16_t sensor_spill_take(uint8_t grid_index) {
+    for (sensor_spill_t *spill = list_head(sensor_spill_list); spill != NULL; spill = spill->next) {
+        if (spill->grid_index == grid_index) {
+            uint8_t sensor_id = spill->sensor_id;
+            sensor_spill_release(spill);
+            return sensor_id;
+        }
+    }
+    return -1;
+}
+
+static void sensor_spill_remove(uint8_t sensor_id) {
+    for (sensor_spill_t *spill = list_head(sensor_spill_list); spill != NULL; spill = spill->next) {
+        if (spill->sensor_id == sensor_id) {
+            sensor_spill_release(spill);
+            return;
+        }
+    }
+}
+
+static void sensor_spill_clear() {
+    sensor_spill_t *spill;
+    while ((spill = list_pop(sensor_spill_list)) != NULL) {
+        memb_free(&sensor_spill_memb, spill);
+    }
+    mobile_robot.num_spilled = 0;
+}
+
 /* Movement and Grid Operations */
 static float calculate_distance(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
     float dx = (float)(x2 - x1);
@@ -173,8 +473,34 @@ static float calculate_distance(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
     return sqrt(dx * dx + dy * dy);
 }
 
+static uint8_t obstacle_map_active() {
+    return OBSTACLE_MAP_ENABLED && mobile_robot.obstacle_map.la_id != 0 &&
+           mobile_robot.obstacle_map.la_id == mobile_robot.assigned_la_id;
+}
+
+/* Travel distance between two points: the planned path when both lie in the
+   assigned LA and its obstacle map is known (negative if the map shows no
+   way through), otherwise a straight line */
+static float route_length(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    uint16_t origin_x = mobile_robot.la_center_x - ROBOT_PERCEPTION_RANGE / 2;
+    uint16_t origin_y = mobile_robot.la_center_y - ROBOT_PERCEPTION_RANGE / 2;
+    
+    if (obstacle_map_active() &&
+        x1 >= origin_x && x1 <= origin_x + ROBOT_PERCEPTION_RANGE &&
+        y1 >= origin_y && y1 <= origin_y + ROBOT_PERCEPTION_RANGE &&
+        x2 >= origin_x && x2 <= origin_x + ROBOT_PERCEPTION_RANGE &&
+        y2 >= origin_y && y2 <= origin_y + ROBOT_PERCEPTION_RANGE) {
+        return path_plan_length(&mobile_robot.obstacle_map, x1 - origin_x, y1 - origin_y,
+                                x2 - origin_x, y2 - origin_y);
+    }
+    return calculate_distance(x1, y1, x2, y2);
+}
+
 static void move_robot(uint16_t new_x, uint16_t new_y) {
-    float distance = calculate_distance(mobile_robot.current_x, mobile_robot.current_y, new_x, new_y);
+    float distance = route_length(mobile_robot.current_x, mobile_robot.current_y, new_x, new_y);
+    if (distance < 0) {
+        distance = calculate_distance(mobile_robot.current_x, mobile_robot.current_y, new_x, new_y);
+    }
     mobile_robot.total_distance_moved += distance;
     mobile_robot.current_x = new_x;
     mobile_robot.current_y = new_y;
@@ -191,28 +517,39 @@ static void initialize_grid_db() {
         mobile_robot.num_grids = MAX_SENSORS_PER_AREA;
         grid_size = (uint8_t)sqrt(mobile_robot.num_grids);
     }
+    mobile_robot.grid_size = grid_size;
     
     uint8_t grid_count = 0;
-    uint16_t start_x = mobile_robot.la_center_x - ROBOT_PERCEPTION_RANGE / 2;
-    uint16_t start_y = mobile_robot.la_center_y - ROBOT_PERCEPTION_RANGE / 2;
+    mobile_robot.la_origin_x = mobile_robot.la_center_x - ROBOT_PERCEPTION_RANGE / 2;
+    mobile_robot.la_origin_y = mobile_robot.la_center_y - ROBOT_PERCEPTION_RANGE / 2;
+    
+    /* All grids start uncovered, and deployable unless the obstacle map says otherwise */
+    memset(mobile_robot.grid_db.covered, 0, sizeof(mobile_robot.grid_db.covered));
+    memset(mobile_robot.grid_db.no_deploy, 0, sizeof(mobile_robot.grid_db.no_deploy));
+    uint8_t no_deploy_grids = 0;
     
     for (uint8_t y = 0; y < grid_size && grid_count < mobile_robot.num_grids; y++) {
         for (uint8_t x = 0; x < grid_size && grid_count < mobile_robot.num_grids; x++) {
-            mobile_robot.grid_db[grid_count].grid_id = grid_count + 1;
-            mobile_robot.grid_db[grid_count].center_x = start_x + x * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2;
-            mobile_robot.grid_db[grid_count].center_y = start_y + y * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2;
-            mobile_robot.grid_db[grid_count].grid_status = 0; // Initially uncovered
+            mobile_robot.grid_db.center_x[grid_count] = x * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2;
+            mobile_robot.grid_db.center_y[grid_count] = y * SENSOR_PERCEPTION_RANGE + SENSOR_PERCEPTION_RANGE / 2;
+            if (obstacle_map_active() &&
+                !obstacle_la_deployable(&mobile_robot.obstacle_map, mobile_robot.grid_db.center_x[grid_count],
+                                        mobile_robot.grid_db.center_y[grid_count])) {
+                db_bit_put(mobile_robot.grid_db.no_deploy, grid_count, 1);
+                no_deploy_grids++;
+            }
             grid_count++;
         }
     }
     
     mobile_robot.no_p = mobile_robot.num_grids; // Set permissible moves
-    LOG_INFO("Initialized %u grids in LA %u\n", mobile_robot.num_grids, mobile_robot.assigned_la_id);
+    LOG_INFO("Initialized %u grids in LA %u, %u not deployable\n", mobile_robot.num_grids,
+             mobile_robot.assigned_la_id, no_deploy_grids);
 }
 
 static int8_t find_uncovered_grid() {
     for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
-        if (mobile_robot.grid_db[i].grid_status == 0) {
+        if (grid_status(i) == 0 && grid_deployable(i)) {
             return i;
         }
     }
@@ -223,14 +560,12 @@ static int8_t find_nearest_sensor_to_grid(uint8_t grid_index) {
     int8_t nearest_sensor = -1;
     float min_distance = 10000.0; // Large initial value
     
-    uint16_t grid_x = mobile_robot.grid_db[grid_index].center_x;
-    uint16_t grid_y = mobile_robot.grid_db[grid_index].center_y;
+    uint16_t grid_x = grid_center_x(grid_index);
+    uint16_t grid_y = grid_center_y(grid_index);
     
     for (uint8_t i = 0; i < mobile_robot.num_sensors; i++) {
-        if (mobile_robot.sensor_db[i].sensor_status == 0) { // Idle sensor
-            float distance = calculate_distance(mobile_robot.sensor_db[i].x_coord, 
-                                             mobile_robot.sensor_db[i].y_coord,
-                                             grid_x, grid_y);
+        if (sensor_status(i) == 0) { // Idle sensor
+            float distance = calculate_distance(sensor_x(i), sensor_y(i), grid_x, grid_y);
             if (distance < min_distance) {
                 min_distance = distance;
                 nearest_sensor = i;
@@ -241,17 +576,237 @@ static int8_t find_nearest_sensor_to_grid(uint8_t grid_index) {
     return nearest_sensor;
 }
 
+/* Journal Operations (local-phase progress on flash) */
+#if ROBOT_JOURNAL_ENABLED
+static journal_record_t journal_batch[JOURNAL_BATCH];
+static uint8_t journal_batch_len;
+
+static void journal_flush() {
+    if (journal_batch_len == 0) {
+        return;
+    }
+    int fd = cfs_open(JOURNAL_FILE, CFS_WRITE | CFS_APPEND);
+    if (fd >= 0) {
+        cfs_write(fd, journal_batch, journal_batch_len * sizeof(journal_record_t));
+        cfs_close(fd);
+    } else {
+        LOG_WARN("Journal: unable to open %s\n", JOURNAL_FILE);
+    }
+    journal_batch_len = 0;
+}
+
+static void journal_append(uint8_t type, uint8_t index, uint16_t a, uint16_t b, uint16_t c) {
+    journal_record_t *record = &journal_batch[journal_batch_len++];
+    record->type = type;
+    record->index = index;
+    record->a = a;
+    record->b = b;
+    record->c = c;
+    if (journal_batch_len == JOURNAL_BATCH) {
+        journal_flush();
+    }
+}
+
+static void journal_log_sensor(uint8_t sensor_index) {
+    journal_append(JOURNAL_REC_SENSOR, sensor_index, sensor_x(sensor_index), sensor_y(sensor_index),
+                   mobile_robot.sensor_db.sensor_id[sensor_index] |
+                   ((uint16_t)sensor_status(sensor_index) << 8));
+}
+
+static void journal_log_unspill(uint8_t sensor_id) {
+    journal_append(JOURNAL_REC_UNSPILL, 0, sensor_id, 0, 0);
+}
+
+/* A collected sensor id pushed onto the stock, or the top one popped */
+static void journal_log_stock(uint8_t pushed_id) {
+    journal_append(JOURNAL_REC_STOCK, mobile_robot.num_stock_ids, pushed_id, 0, 0);
+}
+
+/* Start a fresh journal for a newly assigned LA */
+static void journal_begin_la() {
+    journal_header_t header;
+    int fd;
+    
+    header.magic = JOURNAL_MAGIC;
+    header.robot_id = mobile_robot.robot_id;
+    header.la_id = mobile_robot.assigned_la_id;
+    header.stock_rs = mobile_robot.stock_rs;
+    header.la_center_x = mobile_robot.la_center_x;
+    header.la_center_y = mobile_robot.la_center_y;
+    uip_ipaddr_copy(&header.base_station_addr, &mobile_robot.base_station_addr);
+    header.num_stock_ids = mobile_robot.num_stock_ids;
+    memcpy(header.stock_ids, mobile_robot.stock_ids, sizeof(header.stock_ids));
+    
+    journal_batch_len = 0;
+    cfs_remove(JOURNAL_FILE);
+    fd = cfs_open(JOURNAL_FILE, CFS_WRITE);
+    if (fd < 0) {
+        LOG_WARN("Journal: unable to create %s\n", JOURNAL_FILE);
+        return;
+    }
+    cfs_write(fd, &header, sizeof(header));
+    cfs_close(fd);
+}
+
+/* Commit the discovered Sensor_DB before dispersion starts */
+static void journal_commit_dispersion() {
+    for (uint8_t i = 0; i < mobile_robot.num_sensors; i++) {
+        journal_log_sensor(i);
+    }
+    for (sensor_spill_t *spill = list_head(sensor_spill_list); spill != NULL; spill = spill->next) {
+        journal_append(JOURNAL_REC_SPILL, spill->grid_index, spill->sensor_id, 0, 0);
+    }
+    journal_append(JOURNAL_REC_DISPERSION, 0, mobile_robot.num_sensors,
+                   mobile_robot.stock_rs, mobile_robot.no_p);
+    journal_flush();
+}
+
+/* Commit one processed grid together with the sensors it touched */
+static void journal_commit_grid(uint8_t grid_index, const uint8_t *sensor_indices, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        journal_log_sensor(sensor_indices[i]);
+    }
+    journal_append(JOURNAL_REC_GRID, grid_index, mobile_robot.stock_rs, mobile_robot.no_p,
+                   grid_status(grid_index));
+    journal_flush();
+}
+
+static void journal_clear() {
+    journal_batch_len = 0;
+    cfs_remove(JOURNAL_FILE);
+}
+
+static void journal_apply(const journal_record_t *record, int8_t *last_grid) {
+    switch (record->type) {
+    case JOURNAL_REC_SENSOR:
+        if (record->index < MAX_SENSORS_PER_AREA) {
+            sensor_db_store(record->index, record->c & 0xFF, record->a, record->b, record->c >> 8);
+        }
+        break;
+    case JOURNAL_REC_DISPERSION:
+        mobile_robot.num_sensors = record->a;
+        mobile_robot.stock_rs = record->b;
+        mobile_robot.no_p = record->c;
+        break;
+    case JOURNAL_REC_GRID:
+        if (record->index < mobile_robot.num_grids) {
+            grid_set_status(record->index, record->c);
+            mobile_robot.stock_rs = record->a;
+            mobile_robot.no_p = record->b;
+            *last_grid = record->index;
+        }
+        break;
+    case JOURNAL_REC_SPILL:
+        if (record->index < mobile_robot.num_grids) {
+            sensor_spill_add(record->a, record->index);
+        }
+        break;
+    case JOURNAL_REC_UNSPILL:
+        sensor_spill_remove(record->a);
+        break;
+    case JOURNAL_REC_STOCK:
+        if (record->index <= ROBOT_STOCK_CAPACITY) {
+            if (record->a != 0 && record->index > 0) {
+                mobile_robot.stock_ids[record->index - 1] = record->a;
+            }
+            mobile_robot.num_stock_ids = record->index;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* Rebuild the local phase from the journal. Returns the phase to resume in,
+   or ROBOT_PHASE_IDLE if there is nothing to resume. */
+static robot_phase_t journal_restore() {
+    journal_header_t header;
+    journal_record_t record;
+    uint16_t committed = 0;
+    uint16_t count = 0;
+    int8_t last_grid = -1;
+    int fd = cfs_open(JOURNAL_FILE, CFS_READ);
+    
+    if (fd < 0) {
+        return ROBOT_PHASE_IDLE;
+    }
+    if (cfs_read(fd, &header, sizeof(header)) != sizeof(header) ||
+        header.magic != JOURNAL_MAGIC || header.robot_id != mobile_robot.robot_id) {
+        cfs_close(fd);
+        journal_clear();
+        return ROBOT_PHASE_IDLE;
+    }
+    
+    /* Pass 1: find the last commit point */
+    while (cfs_read(fd, &record, sizeof(record)) == sizeof(record)) {
+        count++;
+        if (record.type == JOURNAL_REC_DISPERSION || record.type == JOURNAL_REC_GRID) {
+            committed = count;
+        }
+    }
+    
+    mobile_robot.assigned_la_id = header.la_id;
+    mobile_robot.la_center_x = header.la_center_x;
+    mobile_robot.la_center_y = header.la_center_y;
+    mobile_robot.stock_rs = header.stock_rs;
+    mobile_robot.num_stock_ids = header.num_stock_ids;
+    if (mobile_robot.num_stock_ids > ROBOT_STOCK_CAPACITY) {
+        mobile_robot.num_stock_ids = ROBOT_STOCK_CAPACITY;
+    }
+    memcpy(mobile_robot.stock_ids, header.stock_ids, sizeof(mobile_robot.stock_ids));
+    uip_ipaddr_copy(&mobile_robot.base_station_addr, &header.base_station_addr);
+    mobile_robot.bs_reachable = 1;
+    
+    if (committed == 0) {
+        /* Crashed during topology discovery: rerun it in the same LA */
+        cfs_close(fd);
+        return ROBOT_PHASE_TOPOLOGY_DISCOVERY;
+    }
+    
+    /* Pass 2: replay up to the last commit over a fresh Grid_DB */
+    PROFILE_CALL(prof_init_grid, initialize_grid_db());
+    cfs_seek(fd, sizeof(header), CFS_SEEK_SET);
+    for (uint16_t i = 0; i < committed && cfs_read(fd, &record, sizeof(record)) == sizeof(record); i++) {
+        journal_apply(&record, &last_grid);
+    }
+    cfs_close(fd);
+    
+    if (last_grid >= 0) {
+        mobile_robot.current_x = grid_center_x(last_grid);
+        mobile_robot.current_y = grid_center_y(last_grid);
+    } else {
+        mobile_robot.current_x = mobile_robot.la_center_x;
+        mobile_robot.current_y = mobile_robot.la_center_y;
+    }
+    
+    LOG_INFO("Journal: restored LA %u with %u sensors, %u collected sensors in stock, %u records committed\n",
+             mobile_robot.assigned_la_id, mobile_robot.num_sensors, mobile_robot.num_stock_ids, committed);
+    return ROBOT_PHASE_DISPERSION;
+}
+#else
+#define journal_log_sensor(sensor_index)
+#define journal_log_unspill(sensor_id)
+#define journal_log_stock(pushed_id)
+#define journal_begin_la()
+#define journal_commit_dispersion()
+#define journal_commit_grid(grid_index, sensor_indices, count)
+#define journal_clear()
+#define journal_restore() ROBOT_PHASE_IDLE
+#endif /* ROBOT_JOURNAL_ENABLED */
+
 /* Phase Operations */
 static void start_topology_discovery() {
     mobile_robot.current_phase = ROBOT_PHASE_TOPOLOGY_DISCOVERY;
     mobile_robot.phase_start_time = clock_time();
     mobile_robot.num_sensors = 0;
+    sensor_spill_clear();
     
     /* Move to center of assigned LA first (as per APP_I algorithm) */
     move_robot(mobile_robot.la_center_x, mobile_robot.la_center_y);
     
     /* Initialize grid database after moving to center */
-    initialize_grid_db();
+    PROFILE_CALL(prof_init_grid, initialize_grid_db());
+    journal_begin_la();
     
     LOG_INFO("Robot %u: Topology discovery in LA %u from center (%u, %u)\n", 
              mobile_robot.robot_id, mobile_robot.assigned_la_id, 
@@ -265,6 +820,7 @@ static void start_topology_discovery() {
     uip_ip6addr(&sensor_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1); // Broadcast to all sensors
     simple_udp_sendto(&udp_conn, &discovery_msg, sizeof(discovery_msg), &sensor_addr);
     mobile_robot.tx_operations++;
+    mobile_robot.mp_sent_time = clock_time();
     
     LOG_INFO("Broadcasted Mp message to discover randomly deployed sensors in LA %u\n", 
              mobile_robot.assigned_la_id);
@@ -276,6 +832,7 @@ static void start_topology_discovery() {
 }
 
 static void execute_dispersion_phase() {
+    latency_hist_record(&hist_discovery, clock_time() - mobile_robot.phase_start_time);
     mobile_robot.current_phase = ROBOT_PHASE_DISPERSION;
     mobile_robot.phase_start_time = clock_time();
     mobile_robot.current_grid_index = 0;
@@ -285,52 +842,129 @@ static void execute_dispersion_phase() {
     
     /* Initialize the permissible movement counter (NO_P) for this local phase */
     mobile_robot.no_p = mobile_robot.num_grids; // As per APP_I algorithm
+    journal_commit_dispersion();
     
     /* Process first grid */
     etimer_set(&phase_timer, 2 * CLOCK_SECOND);
 }
 
-static void deploy_or_relocate_sensor_to_grid(uint8_t sensor_index, uint8_t grid_index, uint8_t deploy_from_stock) {
-    /* Coordinates for deployment/relocation */
-    uint16_t target_x = mobile_robot.grid_db[grid_index].center_x;
-    uint16_t target_y = mobile_robot.grid_db[grid_index].center_y;
-    
-    /* Send deployment/relocation command to sensor */
-    uint16_t command_data[3]; // First two bytes are coordinates, third is deploy flag
-    command_data[0] = target_x;
-    command_data[1] = target_y;
-    command_data[2] = deploy_from_stock; // 1 = new deployment from stock, 0 = relocate existing
+/* Grid command frame: process_grid_deployment() lists every collect, activate
+   and relocate of a grid in one frame, broadcast once the grid is done */
+static void command_begin(uint8_t grid_index) {
+    etimer_stop(&command_timer);
+    mobile_robot.command_seqno++;
+    sensor_cmd_init(&mobile_robot.command, mobile_robot.robot_id, mobile_robot.command_seqno,
+                    grid_center_x(grid_index), grid_center_y(grid_index));
+    memset(mobile_robot.command_acked, 0, sizeof(mobile_robot.command_acked));
+    mobile_robot.command_retries = 0;
+}
+
+static void command_add(uint8_t sensor_id, uint8_t action) {
+    if (!sensor_cmd_add(&mobile_robot.command, sensor_id, action)) {
+        LOG_WARN("Grid command full: sensor %u not told (action %u)\n", sensor_id, action);
+    }
+}
+
+static void command_send() {
+    if (mobile_robot.command.num_entries == 0) {
+        return;
+    }
     
     uip_ipaddr_t sensor_addr;
+    uip_ip6addr(&sensor_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1); // Broadcast, entries addressed by sensor_id
+    simple_udp_sendto(&udp_conn, &mobile_robot.command, sensor_cmd_frame_len(&mobile_robot.command),
+                      &sensor_addr);
+    mobile_robot.tx_operations++;
+    mobile_robot.command_sent_time = clock_time();
+    etimer_set(&command_timer, SENSOR_CMD_ACK_TIMEOUT);
     
-    if (deploy_from_stock) {
-        /* Deploying a new sensor from robot stock - use broadcast to reach undeployed sensors */
-        uip_ip6addr(&sensor_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1); // Broadcast address
-        
-        mobile_robot.stock_rs--; // Reduce stock
-        LOG_INFO("Deploying new sensor from stock to grid %u at (%u, %u), %u sensors remaining in stock\n", 
-                 grid_index, target_x, target_y, mobile_robot.stock_rs);
+    LOG_INFO("Sent grid command %u: %u entries for (%u, %u)\n", mobile_robot.command.seqno,
+             mobile_robot.command.num_entries, mobile_robot.command.x_coord, mobile_robot.command.y_coord);
+}
+
+/* Ack timeout: rebroadcast while entries are missing, then give up on them */
+static void command_timeout() {
+    uint8_t missing = sensor_cmd_unacked(&mobile_robot.command, mobile_robot.command_acked);
+    
+    if (missing == 0) {
+        return;
+    }
+    if (mobile_robot.command_retries < SENSOR_CMD_RETRIES) {
+        mobile_robot.command_retries++;
+        command_send();
+        return;
+    }
+    LOG_WARN("Grid command %u: %u of %u entries unacked after %u retries\n", mobile_robot.command.seqno,
+             missing, mobile_robot.command.num_entries, SENSOR_CMD_RETRIES);
+}
+
+static void handle_command_ack(const sensor_cmd_ack_t *ack) {
+    if (ack->robot_id != mobile_robot.robot_id || ack->seqno != mobile_robot.command.seqno) {
+        return; // Late ack of an earlier grid
+    }
+    if (mobile_robot.command_sent_time != 0) {
+        latency_hist_record(&hist_deploy_confirm, clock_time() - mobile_robot.command_sent_time);
+        mobile_robot.command_sent_time = 0;
+    }
+    for (uint8_t i = 0; i < SENSOR_CMD_BITMAP_BYTES; i++) {
+        mobile_robot.command_acked[i] |= ack->applied[i];
+    }
+    if (sensor_cmd_unacked(&mobile_robot.command, mobile_robot.command_acked) == 0) {
+        etimer_stop(&command_timer);
+    }
+}
+
+/* Place a sensor from Stock_RS at the grid centre; the most recently
+   collected sensor node is the one placed, if the stock holds any */
+static void stock_deploy(uint8_t grid_index) {
+    mobile_robot.stock_rs--;
+    if (mobile_robot.num_stock_ids > 0) {
+        uint8_t sensor_id = mobile_robot.stock_ids[--mobile_robot.num_stock_ids];
+        command_add(sensor_id, SENSOR_CMD_ACTIVATE);
+        journal_log_stock(0);
+        LOG_INFO("Activating collected sensor %u from stock\n", sensor_id);
+    }
+    LOG_INFO("Deploying new sensor from stock to grid %u at (%u, %u), %u sensors remaining in stock\n", 
+             grid_index, grid_center_x(grid_index), grid_center_y(grid_index), mobile_robot.stock_rs);
+}
+
+/* Take a sensor from the grid into Stock_RS */
+static void stock_collect(uint8_t sensor_id) {
+    mobile_robot.stock_rs++;
+    if (mobile_robot.num_stock_ids < ROBOT_STOCK_CAPACITY) {
+        mobile_robot.stock_ids[mobile_robot.num_stock_ids++] = sensor_id;
+        journal_log_stock(sensor_id);
+    }
+    command_add(sensor_id, SENSOR_CMD_COLLECT);
+}
+
+/* Go on to the next uncovered grid, or report once none is left or NO_P is used up */
+static void continue_dispersion() {
+    int8_t next_grid = find_uncovered_grid();
+    if (next_grid >= 0 && mobile_robot.no_p > 0) {
+        /* Continue to next grid */
+        LOG_INFO("Moving to next uncovered grid %d, %d permissible moves remaining\n", 
+                next_grid, mobile_robot.no_p);
+        mobile_robot.current_grid_index = next_grid;
+        etimer_set(&phase_timer, 2 * CLOCK_SECOND);
     } else {
-        /* Relocating an existing sensor - use its specific address if available */
-        if (sensor_index < mobile_robot.num_sensors) {
-            /* We have a specific sensor to relocate */
-            uip_ip6addr(&sensor_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1); // Use broadcast for now (simplified)
-            
-            LOG_INFO("Relocating sensor %u to grid %u at (%u, %u)\n", 
-                     mobile_robot.sensor_db[sensor_index].sensor_id,
-                     grid_index, target_x, target_y);
-        } else {
-            LOG_INFO("Error: Invalid sensor index for relocation\n");
-            return;
+        /* All grids processed or no more permissible moves (NO_P = 0), move to reporting phase */
+        mobile_robot.current_phase = ROBOT_PHASE_REPORTING;
+        
+        /* Count covered grids */
+        uint8_t covered_grids = 0;
+        for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
+            if (grid_status(i) == 1) {
+                covered_grids++;
+            }
         }
+        
+        LOG_INFO("Dispersion phase complete: %u/%u grids covered, %u permissible moves used\n", 
+                 covered_grids, mobile_robot.num_grids, 
+                 mobile_robot.num_grids - mobile_robot.no_p);
+                 
+        etimer_set(&phase_timer, 1 * CLOCK_SECOND);
     }
-    
-    /* Send the command */
-    simple_udp_sendto(&udp_conn, command_data, sizeof(command_data), &sensor_addr);
-    mobile_robot.tx_operations++;
-    
-    /* Mark this grid as covered */
-    mobile_robot.grid_db[grid_index].grid_status = 1;
 }
 
 static void process_grid_deployment(uint8_t grid_index) {
@@ -342,9 +976,21 @@ static void process_grid_deployment(uint8_t grid_index) {
         return;
     }
     
+    /* Skip a grid a sensor cannot be placed in, or the obstacle map shows no way to */
+    if (!grid_deployable(grid_index) ||
+        route_length(mobile_robot.current_x, mobile_robot.current_y,
+                     grid_center_x(grid_index), grid_center_y(grid_index)) < 0) {
+        db_bit_put(mobile_robot.grid_db.no_deploy, grid_index, 1);
+        LOG_INFO("Grid %u at (%u, %u) not deployable or unreachable from (%u, %u), skipped\n",
+                 grid_index + 1, grid_center_x(grid_index), grid_center_y(grid_index),
+                 mobile_robot.current_x, mobile_robot.current_y);
+        continue_dispersion();
+        return;
+    }
+    
     /* Move to grid center */
-    move_robot(mobile_robot.grid_db[grid_index].center_x, 
-               mobile_robot.grid_db[grid_index].center_y);
+    move_robot(grid_center_x(grid_index), grid_center_y(grid_index));
+    command_begin(grid_index);
     
     /* Reduce NO_P by 1 after visiting each grid (as per APP_I) */
     mobile_robot.no_p--;
@@ -354,9 +1000,8 @@ static void process_grid_deployment(uint8_t grid_index) {
     uint8_t grid_sensor_indices[MAX_SENSORS_PER_AREA];
     
     for (uint8_t i = 0; i < mobile_robot.num_sensors; i++) {
-        if (mobile_robot.sensor_db[i].sensor_status == 0) { // Idle sensors only
-            float distance = calculate_distance(mobile_robot.sensor_db[i].x_coord,
-                                              mobile_robot.sensor_db[i].y_coord,
+        if (sensor_status(i) == 0) { // Idle sensors only
+            float distance = calculate_distance(sensor_x(i), sensor_y(i),
                                               mobile_robot.current_x, mobile_robot.current_y);
             if (distance <= SENSOR_PERCEPTION_RANGE && sensors_in_grid < MAX_SENSORS_PER_AREA) {
                 grid_sensor_indices[sensors_in_grid] = i;
@@ -365,49 +1010,59 @@ static void process_grid_deployment(uint8_t grid_index) {
         }
     }
     
-    LOG_INFO("Processing Grid %u at (%u, %u): %u sensors in grid, %u sensors in stock\n",
+    /* Sensors in the overflow tier count towards the grid as well */
+    uint8_t spilled_in_grid = sensor_spill_count(grid_index);
+    uint8_t grid_population = sensors_in_grid + spilled_in_grid;
+    int16_t spilled_id;
+    
+    LOG_INFO("Processing Grid %u at (%u, %u): %u sensors in grid (%u spilled), %u sensors in stock\n",
              grid_index + 1, mobile_robot.current_x, mobile_robot.current_y, 
-             sensors_in_grid, mobile_robot.stock_rs);
+             grid_population, spilled_in_grid, mobile_robot.stock_rs);
     
     /* APP_I Algorithm: 4 Cases of sensor redeployment (as per section y. Local phase) */
     
-    if (mobile_robot.stock_rs > 0 && sensors_in_grid > 0) {
+    if (mobile_robot.stock_rs > 0 && grid_population > 0) {
         /* Case 1: Robot has sensor(s) in Stock_RS and Grid has sensor(s) after random deployment */
         LOG_INFO("Case 1: Stock has sensors, grid has sensors\n");
         
         /* Place a sensor from Stock_RS at the center of grid and mark as active */
-        deploy_or_relocate_sensor_to_grid(0, grid_index, 1); // Deploy from stock
-        mobile_robot.stock_rs--;
+        stock_deploy(grid_index);
         
         /* Collect all extra sensors from grid till Stock_RS is less than 15 */
         uint8_t collected = 0;
         for (uint8_t i = 0; i < sensors_in_grid && mobile_robot.stock_rs < ROBOT_STOCK_CAPACITY; i++) {
             uint8_t sensor_idx = grid_sensor_indices[i];
-            mobile_robot.sensor_db[sensor_idx].sensor_status = 2; // Mark as collected
-            mobile_robot.stock_rs++;
+            sensor_set_status(sensor_idx, 2); // Mark as collected
+            stock_collect(mobile_robot.sensor_db.sensor_id[sensor_idx]);
             collected++;
             LOG_INFO("Collected sensor %u from grid into stock\n", 
-                     mobile_robot.sensor_db[sensor_idx].sensor_id);
+                     mobile_robot.sensor_db.sensor_id[sensor_idx]);
+        }
+        while (mobile_robot.stock_rs < ROBOT_STOCK_CAPACITY &&
+               (spilled_id = sensor_spill_take(grid_index)) >= 0) {
+            journal_log_unspill(spilled_id);
+            stock_collect(spilled_id);
+            collected++;
+            LOG_INFO("Collected spilled sensor %u from grid into stock\n", spilled_id);
         }
         
         /* Mark grid as covered */
-        mobile_robot.grid_db[grid_index].grid_status = 1;
+        grid_set_status(grid_index, 1);
         LOG_INFO("Grid %u covered: deployed 1 from stock, collected %u sensors\n", 
                  grid_index + 1, collected);
         
-    } else if (mobile_robot.stock_rs > 0 && sensors_in_grid == 0) {
+    } else if (mobile_robot.stock_rs > 0 && grid_population == 0) {
         /* Case 2: Robot has sensors in Stock_RS but Grid has no sensors */
         LOG_INFO("Case 2: Stock has sensors, grid has no sensors\n");
         
         /* Place a sensor from Stock_RS at the center of grid and mark as active */
-        deploy_or_relocate_sensor_to_grid(0, grid_index, 1); // Deploy from stock
-        mobile_robot.stock_rs--;
+        stock_deploy(grid_index);
         
         /* Mark grid as covered */
-        mobile_robot.grid_db[grid_index].grid_status = 1;
+        grid_set_status(grid_index, 1);
         LOG_INFO("Grid %u covered: deployed 1 sensor from stock\n", grid_index + 1);
         
-    } else if (mobile_robot.stock_rs == 0 && sensors_in_grid > 0) {
+    } else if (mobile_robot.stock_rs == 0 && grid_population > 0) {
         /* Case 3: Robot has no sensors in Stock_RS but Grid has sensors */
         LOG_INFO("Case 3: No stock, grid has sensors\n");
         
@@ -415,26 +1070,48 @@ static void process_grid_deployment(uint8_t grid_index) {
         int8_t nearest_sensor = find_nearest_sensor_to_grid(grid_index);
         if (nearest_sensor >= 0) {
             /* Place that sensor at grid center and mark as active */
-            deploy_or_relocate_sensor_to_grid(nearest_sensor, grid_index, 0); // Relocate existing
-            mobile_robot.sensor_db[nearest_sensor].sensor_status = 1; // Mark as active
+            command_add(mobile_robot.sensor_db.sensor_id[nearest_sensor], SENSOR_CMD_RELOCATE);
+            sensor_set_status(nearest_sensor, 1); // Mark as active
+            LOG_INFO("Relocating sensor %u to grid %u at (%u, %u)\n",
+                     mobile_robot.sensor_db.sensor_id[nearest_sensor], grid_index,
+                     grid_center_x(grid_index), grid_center_y(grid_index));
+            journal_log_sensor(nearest_sensor);
             
             /* Collect all extra sensors from grid till Stock_RS is less than 15 */
             uint8_t collected = 0;
             for (uint8_t i = 0; i < sensors_in_grid && mobile_robot.stock_rs < ROBOT_STOCK_CAPACITY; i++) {
                 uint8_t sensor_idx = grid_sensor_indices[i];
                 if (sensor_idx != nearest_sensor) { // Don't collect the one we just placed
-                    mobile_robot.sensor_db[sensor_idx].sensor_status = 2; // Mark as collected
-                    mobile_robot.stock_rs++;
+                    sensor_set_status(sensor_idx, 2); // Mark as collected
+                    stock_collect(mobile_robot.sensor_db.sensor_id[sensor_idx]);
                     collected++;
                     LOG_INFO("Collected sensor %u from grid into stock\n", 
-                             mobile_robot.sensor_db[sensor_idx].sensor_id);
+                             mobile_robot.sensor_db.sensor_id[sensor_idx]);
                 }
             }
             
             /* Mark grid as covered */
-            mobile_robot.grid_db[grid_index].grid_status = 1;
+            grid_set_status(grid_index, 1);
             LOG_INFO("Grid %u covered: relocated nearest sensor, collected %u sensors\n", 
                      grid_index + 1, collected);
+        } else if ((spilled_id = sensor_spill_take(grid_index)) >= 0) {
+            /* No idle sensor in the hot table: relocate one from the overflow tier */
+            uint8_t relocated_id = spilled_id;
+            command_add(relocated_id, SENSOR_CMD_RELOCATE);
+            journal_log_unspill(relocated_id);
+            
+            uint8_t collected = 0;
+            while (mobile_robot.stock_rs < ROBOT_STOCK_CAPACITY &&
+                   (spilled_id = sensor_spill_take(grid_index)) >= 0) {
+                journal_log_unspill(spilled_id);
+                stock_collect(spilled_id);
+                collected++;
+                LOG_INFO("Collected spilled sensor %u from grid into stock\n", spilled_id);
+            }
+            
+            grid_set_status(grid_index, 1);
+            LOG_INFO("Grid %u covered: relocated spilled sensor %u, collected %u sensors\n",
+                     grid_index + 1, relocated_id, collected);
         }
         
     } else {
@@ -444,40 +1121,98 @@ static void process_grid_deployment(uint8_t grid_index) {
     }
     
     mobile_robot.processing_operations++;
+    journal_commit_grid(grid_index, grid_sensor_indices, sensors_in_grid);
+    command_send();
     
-    /* Find next uncovered grid within LA */
-    int8_t next_grid = find_uncovered_grid();
-    if (next_grid >= 0 && mobile_robot.no_p > 0) {
-        /* Continue to next grid */
-        LOG_INFO("Moving to next uncovered grid %d, %d permissible moves remaining\n", 
-                next_grid, mobile_robot.no_p);
-        mobile_robot.current_grid_index = next_grid;
-        etimer_set(&phase_timer, 2 * CLOCK_SECOND);
-    } else {
-        /* All grids processed or no more permissible moves (NO_P = 0), move to reporting phase */
-        mobile_robot.current_phase = ROBOT_PHASE_REPORTING;
-        
-        /* Count covered grids */
-        uint8_t covered_grids = 0;
-        for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
-            if (mobile_robot.grid_db[i].grid_status == 1) {
-                covered_grids++;
-            }
+    continue_dispersion();
+}
+
+#if SLEEP_SCHEDULING_ENABLED
+/* Redundancy raster over the current LA, in metres from the LA origin */
+#define SLEEP_RASTER_SIDE ((ROBOT_PERCEPTION_RANGE + SLEEP_RASTER_CELL - 1) / SLEEP_RASTER_CELL)
+static uint64_t sleep_raster_bits[COVERAGE_RASTER_WORDS(SLEEP_RASTER_SIDE, SLEEP_RASTER_SIDE,
+                                                        SLEEP_K_COVERAGE)];
+static coverage_raster_t sleep_raster;
+
+/* After dispersion, find the random sensors left in the field whose sensing
+   disc (within this LA) is already k-covered by awake sensors, and put them
+   on a sleep rotation instead of the random mode toggling. The sensors placed
+   at covered grid centres are awake; the remaining ones are visited in
+   Sensor_DB order and stay awake unless the awake set k-covers them. */
+static void schedule_redundant_sensors() {
+    sleep_schedule_msg_t sleep_msg;
+    uip_ipaddr_t sensor_addr;
+    uint8_t candidates = 0;
+    uint8_t redundant = 0;
+    
+    coverage_raster_init(&sleep_raster, sleep_raster_bits, SLEEP_RASTER_SIDE, SLEEP_RASTER_SIDE,
+                         SLEEP_K_COVERAGE, SLEEP_RASTER_CELL);
+    for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
+        if (grid_status(i) == 1) {
+            coverage_raster_add_disc(&sleep_raster, mobile_robot.grid_db.center_x[i],
+                                     mobile_robot.grid_db.center_y[i], SENSOR_PERCEPTION_RANGE);
         }
+    }
+    
+    sleep_msg.magic[0] = SLEEP_MSG_MAGIC0;
+    sleep_msg.magic[1] = SLEEP_MSG_MAGIC1;
+    sleep_msg.num_slots = SLEEP_ROTATION_SLOTS;
+    uip_ip6addr(&sensor_addr, 0xff02, 0, 0, 0, 0, 0, 0, 1); // Broadcast, addressed by sensor_id
+    
+    for (uint8_t i = 0; i < mobile_robot.num_sensors; i++) {
+        if (sensor_status(i) != 0) {
+            continue; // Placed at a grid centre or collected
+        }
+        candidates++;
         
-        LOG_INFO("Dispersion phase complete: %u/%u grids covered, %u permissible moves used\n", 
-                 covered_grids, mobile_robot.num_grids, 
-                 mobile_robot.num_grids - mobile_robot.no_p);
-                 
-        etimer_set(&phase_timer, 1 * CLOCK_SECOND);
+        if (coverage_raster_disc_covered(&sleep_raster, mobile_robot.sensor_db.x_coord[i],
+                                         mobile_robot.sensor_db.y_coord[i],
+                                         SENSOR_PERCEPTION_RANGE, SLEEP_K_COVERAGE)) {
+            sleep_msg.sensor_id = mobile_robot.sensor_db.sensor_id[i];
+            sleep_msg.slot = redundant % SLEEP_ROTATION_SLOTS;
+            simple_udp_sendto(&udp_conn, &sleep_msg, sizeof(sleep_msg), &sensor_addr);
+            mobile_robot.tx_operations++;
+            redundant++;
+        } else {
+            coverage_raster_add_disc(&sleep_raster, mobile_robot.sensor_db.x_coord[i],
+                                     mobile_robot.sensor_db.y_coord[i], SENSOR_PERCEPTION_RANGE);
+        }
     }
+    mobile_robot.processing_operations++;
+    
+    LOG_INFO("Sleep rotation: %u of %u remaining sensors in LA %u are %u-covered\n",
+             redundant, candidates, mobile_robot.assigned_la_id, SLEEP_K_COVERAGE);
+}
+#endif /* SLEEP_SCHEDULING_ENABLED */
+
+/* Forget the current LA and go back to IDLE for the next assignment;
+   the stock, including collected sensors, is kept */
+static void end_local_phase() {
+    mobile_robot.resume_pending = 0;
+    etimer_stop(&resume_timer);
+    journal_clear();
+    
+    /* Reset NO_P to NO_G for next assignment as per APP_I */
+    mobile_robot.no_p = mobile_robot.num_grids;
+    
+    /* Reset for next assignment */
+    mobile_robot.current_phase = ROBOT_PHASE_IDLE;
+    /* Only the status bitmaps need clearing; coordinates are rewritten on reuse */
+    memset(mobile_robot.grid_db.covered, 0, sizeof(mobile_robot.grid_db.covered));
+    memset(mobile_robot.sensor_db.active, 0, sizeof(mobile_robot.sensor_db.active));
+    memset(mobile_robot.sensor_db.collected, 0, sizeof(mobile_robot.sensor_db.collected));
+    sensor_spill_clear();
+    mobile_robot.num_grids = 0;
+    mobile_robot.num_sensors = 0;
+    
+    LOG_INFO("Robot %u ready for next LA assignment\n", mobile_robot.robot_id);
 }
 
 static void send_coverage_report() {
     /* Count covered grids (Cov_G as per APP_I) */
     uint8_t covered_grids = 0;
     for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
-        if (mobile_robot.grid_db[i].grid_status == 1) {
+        if (grid_status(i) == 1) {
             covered_grids++;
         }
     }
@@ -488,6 +1223,7 @@ static void send_coverage_report() {
     
     LOG_INFO("Local phase complete: %u/%u grids covered (%.2f%%)\n", 
              covered_grids, mobile_robot.num_grids, coverage_percentage);
+    latency_hist_record(&hist_dispersion, clock_time() - mobile_robot.phase_start_time);
     
     /* Send Robot_pM message as specified in APP_I */
     robot_report_msg_t report;
@@ -497,22 +1233,61 @@ static void send_coverage_report() {
     if (mobile_robot.bs_reachable) {
         simple_udp_sendto(&udp_conn, &report, sizeof(report), &mobile_robot.base_station_addr);
         mobile_robot.tx_operations++;
+        mobile_robot.report_sent_time = clock_time();
         
         LOG_INFO("Sent Robot_%uM: (%u, %u) to BS - local phase complete\n", 
                  mobile_robot.robot_id, mobile_robot.robot_id, covered_grids);
     }
     
-    /* Reset NO_P to NO_G for next assignment as per APP_I */
-    mobile_robot.no_p = mobile_robot.num_grids;
-    
-    /* Reset for next assignment */
-    mobile_robot.current_phase = ROBOT_PHASE_IDLE;
-    memset(mobile_robot.grid_db, 0, sizeof(mobile_robot.grid_db));
-    memset(mobile_robot.sensor_db, 0, sizeof(mobile_robot.sensor_db));
-    mobile_robot.num_grids = 0;
-    mobile_robot.num_sensors = 0;
+#if SLEEP_SCHEDULING_ENABLED
+    schedule_redundant_sensors();
+#endif /* SLEEP_SCHEDULING_ENABLED */
     
-    LOG_INFO("Robot %u ready for next LA assignment\n", mobile_robot.robot_id);
+    /* Local phase is reported; nothing left to resume */
+    end_local_phase();
+}
+
+/* Topology discovery: add a Sensor_M reply to Sensor_DB */
+static void handle_discovery_reply(const sensor_reply_msg_t *sensor_reply) {
+    latency_hist_record(&hist_mp_reply, clock_time() - mobile_robot.mp_sent_time);
+    
+    /* Check if sensor is within robot's perception range and within assigned LA */
+    float distance_to_robot = calculate_distance(sensor_reply->x_coord, sensor_reply->y_coord,
+                                               mobile_robot.current_x, mobile_robot.current_y);
+    
+    /* Also check if sensor is within the LA boundaries */
+    uint16_t la_start_x = mobile_robot.la_center_x - ROBOT_PERCEPTION_RANGE / 2;
+    uint16_t la_end_x = mobile_robot.la_center_x + ROBOT_PERCEPTION_RANGE / 2;
+    uint16_t la_start_y = mobile_robot.la_center_y - ROBOT_PERCEPTION_RANGE / 2;
+    uint16_t la_end_y = mobile_robot.la_center_y + ROBOT_PERCEPTION_RANGE / 2;
+    
+    bool within_la = (sensor_reply->x_coord >= la_start_x && sensor_reply->x_coord <= la_end_x &&
+                     sensor_reply->y_coord >= la_start_y && sensor_reply->y_coord <= la_end_y);
+    
+    if (distance_to_robot <= ROBOT_PERCEPTION_RANGE && within_la && 
+        mobile_robot.num_sensors >= MAX_SENSORS_PER_AREA) {
+        /* Hot table full: keep the sensor in the compact overflow tier */
+        uint8_t grid_index = grid_index_at(sensor_reply->x_coord, sensor_reply->y_coord);
+        if (sensor_spill_add(sensor_reply->sensor_id, grid_index)) {
+            log_queue_post(ROBOT_LOG_SENSOR_SPILLED, sensor_reply->sensor_id, grid_index + 1, 0, 0);
+        } else {
+            log_queue_post(ROBOT_LOG_SENSOR_DROPPED, sensor_reply->sensor_id,
+                           mobile_robot.spill_dropped, 0, 0);
+        }
+    } else if (distance_to_robot <= ROBOT_PERCEPTION_RANGE && within_la) {
+        
+        /* Add sensor to database */
+        sensor_db_store(mobile_robot.num_sensors, sensor_reply->sensor_id,
+                        sensor_reply->x_coord, sensor_reply->y_coord,
+                        sensor_reply->sensor_status);
+        mobile_robot.num_sensors++;
+        
+        log_queue_post(ROBOT_LOG_SENSOR_FOUND, sensor_reply->sensor_id, sensor_reply->x_coord,
+                       sensor_reply->y_coord, sensor_reply->sensor_status);
+    } else if (!within_la) {
+        log_queue_post(ROBOT_LOG_SENSOR_OUTSIDE, sensor_reply->sensor_id, sensor_reply->x_coord,
+                       sensor_reply->y_coord, mobile_robot.assigned_la_id);
+    }
 }
 
 /* Add new message structure to match base station */
@@ -532,6 +1307,52 @@ static void udp_rx_callback(struct simple_udp_connection *c,
     
     mobile_robot.rx_operations++;
     
+    if (latency_is_request(data, datalen)) {
+        uint16_t frame_len = latency_frame_build(LATENCY_NODE_ROBOT, robot_hists, ROBOT_NUM_HISTS,
+                                                 latency_frame, sizeof(latency_frame));
+        simple_udp_sendto(&udp_conn, latency_frame, frame_len, sender_addr);
+        mobile_robot.tx_operations++;
+        return;
+    }
+    
+    /* BS acknowledgement of Robot_RM */
+    if (datalen == sizeof(robot_resume_ack_msg_t) && data[0] == RESUME_ACK_MAGIC0 &&
+        data[1] == RESUME_ACK_MAGIC1) {
+        const robot_resume_ack_msg_t *ack = (const robot_resume_ack_msg_t *)data;
+        if (ack->robot_id == mobile_robot.robot_id && mobile_robot.resume_pending) {
+            mobile_robot.resume_pending = 0;
+            etimer_stop(&resume_timer);
+            if (ack->la_id != mobile_robot.assigned_la_id) {
+                /* The BS finished this LA or gave it to another robot: drop the
+                   journaled phase and wait for the BS's assignment instead */
+                LOG_WARN("BS refused resume of LA %u (has LA %u on record)\n",
+                         mobile_robot.assigned_la_id, ack->la_id);
+                etimer_stop(&phase_timer);
+                etimer_stop(&discovery_timer);
+                etimer_stop(&command_timer);
+                end_local_phase();
+            }
+        }
+        return;
+    }
+    
+    /* Sensor ack of a grid command frame */
+    if (sensor_cmd_is_ack(data, datalen)) {
+        handle_command_ack((const sensor_cmd_ack_t *)data);
+        return;
+    }
+    
+    /* Obstacle map of the LA about to be assigned; kept until the next one */
+    if (datalen == sizeof(obstacle_map_msg_t) && data[0] == OBSTACLE_MSG_MAGIC0 &&
+        data[1] == OBSTACLE_MSG_MAGIC1) {
+        const obstacle_map_msg_t *map_msg = (const obstacle_map_msg_t *)data;
+        if (map_msg->target_robot_id == mobile_robot.robot_id &&
+            mobile_robot.current_phase == ROBOT_PHASE_IDLE) {
+            memcpy(&mobile_robot.obstacle_map, &map_msg->map, sizeof(mobile_robot.obstacle_map));
+        }
+        return;
+    }
+    
     /* Handle robot assignment message from base station */
     if (datalen == sizeof(robot_assignment_msg_t)) {
         robot_assignment_msg_t *assignment_msg = (robot_assignment_msg_t *)data;
@@ -549,50 +1370,88 @@ static void udp_rx_callback(struct simple_udp_connection *c,
             uip_ipaddr_copy(&mobile_robot.base_station_addr, sender_addr);
             mobile_robot.bs_reachable = 1;
             
-            LOG_INFO("Robot %u received LA assignment: LA %u at (%u, %u)\n", 
-                     mobile_robot.robot_id, assignment->la_id, assignment->center_x, assignment->center_y);
+            log_queue_post(ROBOT_LOG_ASSIGNMENT, assignment->la_id,
+                           assignment->center_x, assignment->center_y, 0);
+            
+            if (mobile_robot.report_sent_time != 0) {
+                latency_hist_record(&hist_report_assign, clock_time() - mobile_robot.report_sent_time);
+                mobile_robot.report_sent_time = 0;
+            }
+            
+            if (OBSTACLE_MAP_ENABLED && !obstacle_map_active()) {
+                LOG_WARN("No obstacle map for LA %u: moving in straight lines\n", assignment->la_id);
+            }
             
             /* Start topology discovery */
             start_topology_discovery();
         }
     }
     
+    
     /* Handle sensor replies during topology discovery */
     if (datalen == sizeof(sensor_reply_msg_t) && mobile_robot.current_phase == ROBOT_PHASE_TOPOLOGY_DISCOVERY) {
-        sensor_reply_msg_t *sensor_reply = (sensor_reply_msg_t *)data;
-        
-        /* Check if sensor is within robot's perception range and within assigned LA */
-        float distance_to_robot = calculate_distance(sensor_reply->x_coord, sensor_reply->y_coord,
-                                                   mobile_robot.current_x, mobile_robot.current_y);
-        
-        /* Also check if sensor is within the LA boundaries */
-        uint16_t la_start_x = mobile_robot.la_center_x - ROBOT_PERCEPTION_RANGE / 2;
-        uint16_t la_end_x = mobile_robot.la_center_x + ROBOT_PERCEPTION_RANGE / 2;
-        uint16_t la_start_y = mobile_robot.la_center_y - ROBOT_PERCEPTION_RANGE / 2;
-        uint16_t la_end_y = mobile_robot.la_center_y + ROBOT_PERCEPTION_RANGE / 2;
+        PROFILE_CALL(prof_discovery, handle_discovery_reply((const sensor_reply_msg_t *)data));
+    }
+}
+
+static void udp_rx_profiled(struct simple_udp_connection *c,
+                            const uip_ipaddr_t *sender_addr,
+                            uint16_t sender_port,
+                            const uip_ipaddr_t *receiver_addr,
+                            uint16_t receiver_port,
+                            const uint8_t *data,
+                            uint16_t datalen) {
+    radio_trace_record(sender_addr, sender_port, receiver_addr, receiver_port, data, datalen);
+    PROFILE_CALL(prof_udp_rx, udp_rx_callback(c, sender_addr, sender_port, receiver_addr,
+                                              receiver_port, data, datalen));
+}
+
+/* Resume a journaled local phase after a reboot or brownout */
+static void resume_local_phase(robot_phase_t phase) {
+    if (phase == ROBOT_PHASE_TOPOLOGY_DISCOVERY) {
+        LOG_INFO("Robot %u resuming LA %u from topology discovery\n",
+                 mobile_robot.robot_id, mobile_robot.assigned_la_id);
+        start_topology_discovery();
+    } else {
+        int8_t next_grid = find_uncovered_grid();
         
-        bool within_la = (sensor_reply->x_coord >= la_start_x && sensor_reply->x_coord <= la_end_x &&
-                         sensor_reply->y_coord >= la_start_y && sensor_reply->y_coord <= la_end_y);
+        mobile_robot.current_phase = ROBOT_PHASE_DISPERSION;
+        mobile_robot.phase_start_time = clock_time();
+        mobile_robot.current_grid_index = (next_grid >= 0) ? next_grid : mobile_robot.num_grids;
+        etimer_set(&phase_timer, 2 * CLOCK_SECOND);
         
-        if (distance_to_robot <= ROBOT_PERCEPTION_RANGE && within_la && 
-            mobile_robot.num_sensors < MAX_SENSORS_PER_AREA) {
-            
-            /* Add sensor to database */
-            mobile_robot.sensor_db[mobile_robot.num_sensors].sensor_id = sensor_reply->sensor_id;
-            mobile_robot.sensor_db[mobile_robot.num_sensors].x_coord = sensor_reply->x_coord;
-            mobile_robot.sensor_db[mobile_robot.num_sensors].y_coord = sensor_reply->y_coord;
-            mobile_robot.sensor_db[mobile_robot.num_sensors].sensor_status = sensor_reply->sensor_status;
-            mobile_robot.num_sensors++;
-            
-            LOG_INFO("Discovered sensor %u at (%u, %u) within LA %u, status: %u\n", 
-                     sensor_reply->sensor_id, sensor_reply->x_coord, 
-                     sensor_reply->y_coord, mobile_robot.assigned_la_id, sensor_reply->sensor_status);
-        } else if (!within_la) {
-            LOG_INFO("Sensor %u at (%u, %u) outside LA %u boundaries - ignored\n", 
-                     sensor_reply->sensor_id, sensor_reply->x_coord, 
-                     sensor_reply->y_coord, mobile_robot.assigned_la_id);
+        LOG_INFO("Robot %u resuming dispersion in LA %u at grid %d, %u in stock, %u permissible moves\n",
+                 mobile_robot.robot_id, mobile_robot.assigned_la_id, next_grid,
+                 mobile_robot.stock_rs, mobile_robot.no_p);
+    }
+    
+    /* Tell the BS we are still working this LA so it does not time us out.
+       Routing is not up this early after boot, so Robot_RM goes out from
+       resume_timer once the BS is reachable, and again until it is acked. */
+    mobile_robot.resume_pending = 1;
+    etimer_set(&resume_timer, ROBOT_RESUME_RETRY_INTERVAL);
+}
+
+static void send_resume_message() {
+    robot_resume_msg_t resume;
+    
+    if (!NETSTACK_ROUTING.node_is_reachable()) {
+        return;
+    }
+    resume.robot_id = mobile_robot.robot_id;
+    resume.la_id = mobile_robot.assigned_la_id;
+    resume.next_grid = mobile_robot.current_grid_index;
+    resume.covered_grids = 0;
+    for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
+        if (grid_status(i) == 1) {
+            resume.covered_grids++;
         }
     }
+    simple_udp_sendto(&udp_conn, &resume, sizeof(resume), &mobile_robot.base_station_addr);
+    mobile_robot.tx_operations++;
+    
+    LOG_INFO("Sent Robot_%uRM: resuming LA %u with %u grids covered\n",
+             mobile_robot.robot_id, resume.la_id, resume.covered_grids);
 }
 
 static void print_energy_report() {
@@ -607,6 +1466,8 @@ static void print_energy_report() {
     LOG_INFO("Phase: %u\n", mobile_robot.current_phase);
     LOG_INFO("Assigned LA: %u\n", mobile_robot.assigned_la_id);
     LOG_INFO("Sensor stock: %u\n", mobile_robot.stock_rs);
+    LOG_INFO("Sensor_DB: %u hot, %u spilled, %u dropped\n",
+            mobile_robot.num_sensors, mobile_robot.num_spilled, mobile_robot.spill_dropped);
     LOG_INFO("Elapsed time: %.2f seconds\n", elapsed_seconds);
     LOG_INFO("Baseline energy: %.6f J\n", mobile_robot.baseline_energy);
     LOG_INFO("Radio energy: %.6f J\n", mobile_robot.radio_energy);
@@ -615,9 +1476,120 @@ static void print_energy_report() {
     LOG_INFO("Operations - TX: %u, RX: %u, Moves: %u, Processing: %u\n",
             mobile_robot.tx_operations, mobile_robot.rx_operations,
             mobile_robot.movement_operations, mobile_robot.processing_operations);
+#if OBSTACLE_MAP_ENABLED
+    uint32_t path_hits, path_misses;
+    path_cache_stats(&path_hits, &path_misses);
+    LOG_INFO("Path cache: %lu hits, %lu plans\n", (unsigned long)path_hits, (unsigned long)path_misses);
+#endif /* OBSTACLE_MAP_ENABLED */
+    LOG_INFO("PAPER_ROBOT, %u, %.3f, %lu, %lu, %.3f, %.9f, %.9f, %.9f, %.9f\n",
+             mobile_robot.robot_id, elapsed_seconds,
+             (unsigned long)mobile_robot.total_tx_operations,
+             (unsigned long)mobile_robot.total_rx_operations, mobile_robot.cumulative_distance,
+             mobile_robot.baseline_energy, mobile_robot.radio_energy,
+             mobile_robot.mobility_energy, mobile_robot.total_energy_consumed);
+    for (uint8_t i = 0; i < ROBOT_NUM_HISTS; i++) {
+        latency_hist_log(robot_hists[i]);
+    }
+    log_queue_log_stats();
     LOG_INFO("==========================\n");
 }
 
+/* Shell Commands (live inspection over the serial console) */
+#if NODE_SHELL_ENABLED
+static PT_THREAD(cmd_grid_db(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Grid_DB: LA %u, %u grids, current grid %u\n",
+                 mobile_robot.assigned_la_id, mobile_robot.num_grids, mobile_robot.current_grid_index + 1);
+    SHELL_OUTPUT(output, "grid_id, center_x, center_y, status, spilled, deployable\n");
+    for (uint8_t i = 0; i < mobile_robot.num_grids; i++) {
+        SHELL_OUTPUT(output, "%u, %u, %u, %u, %u, %u\n", i + 1, grid_center_x(i), grid_center_y(i),
+                     grid_status(i), sensor_spill_count(i), grid_deployable(i));
+    }
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_sensor_db(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Sensor_DB: %u hot, %u spilled, %u dropped\n",
+                 mobile_robot.num_sensors, mobile_robot.num_spilled, mobile_robot.spill_dropped);
+    SHELL_OUTPUT(output, "sensor_id, x, y, status\n");
+    for (uint8_t i = 0; i < mobile_robot.num_sensors; i++) {
+        SHELL_OUTPUT(output, "%u, %u, %u, %u\n", mobile_robot.sensor_db.sensor_id[i],
+                     sensor_x(i), sensor_y(i), sensor_status(i));
+    }
+    for (sensor_spill_t *spill = list_head(sensor_spill_list); spill != NULL; spill = list_item_next(spill)) {
+        SHELL_OUTPUT(output, "%u, grid %u, spilled\n", spill->sensor_id, spill->grid_index + 1);
+    }
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_stock(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Robot %u at (%u, %u), phase %u, LA %u\n", mobile_robot.robot_id,
+                 mobile_robot.current_x, mobile_robot.current_y,
+                 mobile_robot.current_phase, mobile_robot.assigned_la_id);
+    SHELL_OUTPUT(output, "Sensor stock: %u (%u collected sensor nodes), permissible moves: %u\n",
+                 mobile_robot.stock_rs, mobile_robot.num_stock_ids, mobile_robot.no_p);
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_energy(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    update_energy_consumption();
+    SHELL_OUTPUT(output, "Baseline energy: %.6f J\n", mobile_robot.baseline_energy);
+    SHELL_OUTPUT(output, "Radio energy: %.6f J\n", mobile_robot.radio_energy);
+    SHELL_OUTPUT(output, "Mobility energy: %.6f J\n", mobile_robot.mobility_energy);
+    SHELL_OUTPUT(output, "Total energy: %.6f J\n", mobile_robot.total_energy_consumed);
+    /* The update above folds total_distance_moved into D_p and zeroes it */
+    SHELL_OUTPUT(output, "Distance moved (cumulative): %.2f m\n", mobile_robot.cumulative_distance);
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_profile(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    /* tx/rx_operations restart at every energy update; report them cumulatively */
+    SHELL_OUTPUT(output, "Operations (cumulative) - TX: %lu, RX: %lu, Moves: %lu, Processing: %lu\n",
+                 (unsigned long)(mobile_robot.total_tx_operations + mobile_robot.tx_operations),
+                 (unsigned long)(mobile_robot.total_rx_operations + mobile_robot.rx_operations),
+                 (unsigned long)mobile_robot.movement_operations,
+                 (unsigned long)mobile_robot.processing_operations);
+    node_shell_profile(output, robot_scopes, sizeof(robot_scopes) / sizeof(robot_scopes[0]));
+    
+    PT_END(pt);
+}
+
+static const struct shell_command_t robot_shell_commands[] = {
+    { "grid-db", cmd_grid_db, "'> grid-db': Dump Grid_DB of the current LA" },
+    { "sensor-db", cmd_sensor_db, "'> sensor-db': Dump Sensor_DB including the overflow tier" },
+    { "stock", cmd_stock, "'> stock': Show position, phase, sensor stock and permissible moves" },
+    { "energy", cmd_energy, "'> energy': Show energy counters" },
+    { "profile", cmd_profile, "'> profile': Show operation and profiling scope counters" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t robot_shell_command_set = {
+    .next = NULL,
+    .commands = robot_shell_commands,
+};
+#endif /* NODE_SHELL_ENABLED */
+
+#if RADIO_REPLAY_ENABLED
+static void replay_done() {
+    print_energy_report();
+    profile_report_log("Robot", mobile_robot.robot_id, robot_scopes,
+                       sizeof(robot_scopes) / sizeof(robot_scopes[0]));
+}
+#endif /* RADIO_REPLAY_ENABLED */
+
 PROCESS_THREAD(mobile_robot_process, ev, data) {
     PROCESS_BEGIN();
     
@@ -628,17 +1600,36 @@ PROCESS_THREAD(mobile_robot_process, ev, data) {
     mobile_robot.current_phase = ROBOT_PHASE_IDLE;
     mobile_robot.stock_rs = ROBOT_INITIAL_STOCK;
     mobile_robot.bs_reachable = 0;
+    log_queue_init("MobileRobot", robot_log_events, ROBOT_LOG_NUM_EVENTS);
+    memb_init(&sensor_spill_memb);
+    list_init(sensor_spill_list);
+    
+    latency_hist_init(&hist_mp_reply, "Mp->Sensor_M");
+    latency_hist_init(&hist_deploy_confirm, "command->ack");
+    latency_hist_init(&hist_report_assign, "report->assign");
+    latency_hist_init(&hist_discovery, "discovery");
+    latency_hist_init(&hist_dispersion, "dispersion");
     
     /* Initialize position (robots start at base station area) */
     mobile_robot.current_x = TARGET_AREA_WIDTH / 2;
     mobile_robot.current_y = TARGET_AREA_HEIGHT / 2;
     
     /* Initialize UDP connection */
-    simple_udp_register(&udp_conn, UDP_SERVER_PORT, NULL, UDP_CLIENT_PORT, udp_rx_callback);
+    simple_udp_register(&udp_conn, UDP_SERVER_PORT, NULL, UDP_CLIENT_PORT, udp_rx_profiled);
+    radio_replay_start(&udp_conn, udp_rx_profiled, replay_done);
     
     /* Set energy reporting timer */
     etimer_set(&energy_timer, ENERGY_REPORT_INTERVAL);
     
+    /* Register inspection commands on the serial shell */
+    node_shell_init(&robot_shell_command_set);
+    
+    /* Pick up an interrupted local phase from the journal */
+    robot_phase_t resume_phase = journal_restore();
+    if (resume_phase != ROBOT_PHASE_IDLE) {
+        resume_local_phase(resume_phase);
+    }
+    
     LOG_INFO("Mobile Robot %u initialized with %u sensors in stock\n", 
              mobile_robot.robot_id, mobile_robot.stock_rs);
     
@@ -648,11 +1639,20 @@ PROCESS_THREAD(mobile_robot_process, ev, data) {
         if (ev == PROCESS_EVENT_TIMER) {
             if (data == &phase_timer) {
                 if (mobile_robot.current_phase == ROBOT_PHASE_DISPERSION) {
-                    process_grid_deployment(mobile_robot.current_grid_index);
+                    PROFILE_CALL(prof_grid, process_grid_deployment(mobile_robot.current_grid_index));
                 } else if (mobile_robot.current_phase == ROBOT_PHASE_REPORTING) {
                     send_coverage_report();
                 }
                 
+            } else if (data == &command_timer) {
+                command_timeout();
+                
+            } else if (data == &resume_timer) {
+                if (mobile_robot.resume_pending) {
+                    send_resume_message();
+                    etimer_reset(&resume_timer);
+                }
+                
             } else if (data == &discovery_timer) {
                 if (mobile_robot.current_phase == ROBOT_PHASE_TOPOLOGY_DISCOVERY) {
                     LOG_INFO("Topology discovery complete. Found %u sensors\n", mobile_robot.num_sensors);
@@ -661,6 +1661,8 @@ PROCESS_THREAD(mobile_robot_process, ev, data) {
                 
             } else if (data == &energy_timer) {
                 print_energy_report();
+                profile_report_log("Robot", mobile_robot.robot_id, robot_scopes,
+                                   sizeof(robot_scopes) / sizeof(robot_scopes[0]));
                 etimer_reset(&energy_timer);
             }
         }
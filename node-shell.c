@@ -0,0 +1,87 @@
+#include "node-shell.h"
+#include "log-queue.h"
+#include "sys/log.h"
+#include <string.h>
+
+int app_log_level = LOG_LEVEL_APP;
+
+#if NODE_SHELL_ENABLED
+static const struct {
+    const char *name;
+    int level;
+} app_log_levels[] = {
+    { "none", LOG_LEVEL_NONE },
+    { "err", LOG_LEVEL_ERR },
+    { "warn", LOG_LEVEL_WARN },
+    { "info", LOG_LEVEL_INFO },
+    { "dbg", LOG_LEVEL_DBG },
+};
+#define NUM_APP_LOG_LEVELS (sizeof(app_log_levels) / sizeof(app_log_levels[0]))
+
+static PT_THREAD(cmd_app_log(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    if (args != NULL && *args != '\0') {
+        uint8_t found = 0;
+        for (uint8_t i = 0; i < NUM_APP_LOG_LEVELS; i++) {
+            if (strcmp(args, app_log_levels[i].name) == 0) {
+                app_log_level = app_log_levels[i].level;
+                found = 1;
+                break;
+            }
+        }
+        if (!found) {
+            SHELL_OUTPUT(output, "Unknown level '%s' (none|err|warn|info|dbg)\n", args);
+        }
+    }
+    for (uint8_t i = 0; i < NUM_APP_LOG_LEVELS; i++) {
+        if (app_log_levels[i].level == app_log_level) {
+            SHELL_OUTPUT(output, "Application log level: %s\n", app_log_levels[i].name);
+        }
+    }
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_log_queue(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "event, posted, dropped\n");
+    for (uint8_t i = 0; i < log_queue_num_types(); i++) {
+        SHELL_OUTPUT(output, "%u, %lu, %lu\n", i,
+                     (unsigned long)log_queue_posted(i), (unsigned long)log_queue_dropped(i));
+    }
+    
+    PT_END(pt);
+}
+
+void node_shell_profile(shell_output_func output, profile_scope_t *const *scopes, uint8_t num_scopes) {
+    SHELL_OUTPUT(output, "scope, calls, total_us, avg_us, max_us\n");
+    for (uint8_t i = 0; i < num_scopes; i++) {
+        const profile_scope_t *scope = scopes[i];
+        uint32_t total_us = profile_ticks_to_us(scope->total_ticks);
+        SHELL_OUTPUT(output, "%s, %lu, %lu, %lu, %lu\n", scope->name,
+                     (unsigned long)scope->calls, (unsigned long)total_us,
+                     (unsigned long)(scope->calls ? total_us / scope->calls : 0),
+                     (unsigned long)profile_ticks_to_us(scope->max_ticks));
+    }
+}
+
+static const struct shell_command_t common_commands[] = {
+    { "app-log", cmd_app_log, "'> app-log [none|err|warn|info|dbg]': Show or set the application log level" },
+    { "log-queue", cmd_log_queue, "'> log-queue': Show deferred log events posted and dropped per type" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t common_command_set = {
+    .next = NULL,
+    .commands = common_commands,
+};
+
+void node_shell_init(struct shell_command_set_t *node_commands) {
+    shell_command_set_register(&common_command_set);
+    if (node_commands != NULL) {
+        shell_command_set_register(node_commands);
+    }
+}
+#endif /* NODE_SHELL_ENABLED */
@@ -0,0 +1,25 @@
+#ifndef NODE_SHELL_H_
+#define NODE_SHELL_H_
+
+#include "contiki.h"
+#include "project-conf.h"
+
+/* Runtime application log level; node files use it as their LOG_LEVEL so
+   LOG_INFO and friends can be silenced or raised without a rebuild */
+extern int app_log_level;
+
+#if NODE_SHELL_ENABLED
+#include "shell.h"
+#include "shell-commands.h"
+#include "profile-scope.h"
+
+/* Register the common commands plus a node-specific command set */
+void node_shell_init(struct shell_command_set_t *node_commands);
+
+/* Print profiling scope counters to the shell */
+void node_shell_profile(shell_output_func output, profile_scope_t *const *scopes, uint8_t num_scopes);
+#else
+#define node_shell_init(node_commands)
+#endif /* NODE_SHELL_ENABLED */
+
+#endif /* NODE_SHELL_H_ */
@@ -0,0 +1,70 @@
+#include "obstacle-map.h"
+#include "obstacle-map-data.h"
+#include <string.h>
+
+#if OBSTACLE_MAP_DATA_WIDTH != OBSTACLE_MAP_WIDTH || OBSTACLE_MAP_DATA_HEIGHT != OBSTACLE_MAP_HEIGHT
+#error "obstacle-map-data.h does not match the target area: rerun tools/obstacle-map.py"
+#endif
+
+static inline uint8_t bit_get(const uint8_t *bitmap, uint16_t index) {
+    return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline void bit_set(uint8_t *bitmap, uint16_t index) {
+    bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+}
+
+void obstacle_map_stats(uint16_t *blocked, uint16_t *no_deploy) {
+    *blocked = 0;
+    *no_deploy = 0;
+    for (uint16_t i = 0; i < OBSTACLE_MAP_WIDTH * OBSTACLE_MAP_HEIGHT; i++) {
+        *blocked += bit_get(obstacle_map_blocked, i);
+        *no_deploy += bit_get(obstacle_map_no_deploy, i);
+    }
+}
+
+void obstacle_map_extract(uint8_t la_id, uint16_t origin_x, uint16_t origin_y,
+                          obstacle_la_map_t *la_map) {
+    uint16_t first_x = origin_x / OBSTACLE_CELL;
+    uint16_t first_y = origin_y / OBSTACLE_CELL;
+    
+    memset(la_map, 0, sizeof(*la_map));
+    la_map->la_id = la_id;
+    
+    for (uint8_t cy = 0; cy < OBSTACLE_LA_SIDE; cy++) {
+        for (uint8_t cx = 0; cx < OBSTACLE_LA_SIDE; cx++) {
+            uint16_t x = first_x + cx;
+            uint16_t y = first_y + cy;
+            obstacle_cell_t cell = cy * OBSTACLE_LA_SIDE + cx;
+            
+            if (x >= OBSTACLE_MAP_WIDTH || y >= OBSTACLE_MAP_HEIGHT) {
+                bit_set(la_map->blocked, cell);
+                bit_set(la_map->no_deploy, cell);
+                continue;
+            }
+            if (bit_get(obstacle_map_blocked, y * OBSTACLE_MAP_WIDTH + x)) {
+                bit_set(la_map->blocked, cell);
+            }
+            if (bit_get(obstacle_map_no_deploy, y * OBSTACLE_MAP_WIDTH + x)) {
+                bit_set(la_map->no_deploy, cell);
+            }
+        }
+    }
+}
+
+uint8_t obstacle_la_blocked(const obstacle_la_map_t *la_map, int16_t cx, int16_t cy) {
+    if (cx < 0 || cy < 0 || cx >= OBSTACLE_LA_SIDE || cy >= OBSTACLE_LA_SIDE) {
+        return 1;
+    }
+    return bit_get(la_map->blocked, cy * OBSTACLE_LA_SIDE + cx);
+}
+
+uint8_t obstacle_la_deployable(const obstacle_la_map_t *la_map, uint16_t x, uint16_t y) {
+    uint16_t cx = x / OBSTACLE_CELL;
+    uint16_t cy = y / OBSTACLE_CELL;
+    
+    if (cx >= OBSTACLE_LA_SIDE || cy >= OBSTACLE_LA_SIDE) {
+        return 0;
+    }
+    return !bit_get(la_map->no_deploy, cy * OBSTACLE_LA_SIDE + cx);
+}
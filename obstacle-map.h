@@ -0,0 +1,61 @@
+#ifndef OBSTACLE_MAP_H_
+#define OBSTACLE_MAP_H_
+
+#include <stdint.h>
+#include "project-conf.h"
+
+/* Obstacle map of the target area in square cells of OBSTACLE_CELL metres.
+   A blocked cell (rubble, water) can neither be crossed by a robot nor hold a
+   sensor; a no-deploy cell can be crossed but not hold a sensor. The BS holds
+   the whole map (obstacle-map-data.h, generated by tools/obstacle-map.py) and
+   sends each robot the part covering its LA. Bitmaps are row-major, bit i % 8
+   of byte i / 8. */
+#define OBSTACLE_MAP_WIDTH (TARGET_AREA_WIDTH / OBSTACLE_CELL)
+#define OBSTACLE_MAP_HEIGHT (TARGET_AREA_HEIGHT / OBSTACLE_CELL)
+#define OBSTACLE_LA_SIDE (ROBOT_PERCEPTION_RANGE / OBSTACLE_CELL)
+#define OBSTACLE_LA_CELLS (OBSTACLE_LA_SIDE * OBSTACLE_LA_SIDE)
+#define OBSTACLE_LA_BYTES ((OBSTACLE_LA_CELLS + 7) / 8)
+
+#if OBSTACLE_LA_SIDE > 255
+#error "LA map sides are uint8_t: ROBOT_PERCEPTION_RANGE / OBSTACLE_CELL must not exceed 255"
+#endif
+
+/* Cell index within an LA map: one byte while the LA has at most 255 cells
+   (side <= 15), two beyond that (e.g. ROBOT_PERCEPTION_RANGE 200 at 10 m) */
+#if OBSTACLE_LA_CELLS > 255
+typedef uint16_t obstacle_cell_t;
+#else
+typedef uint8_t obstacle_cell_t;
+#endif
+
+/* The map of one LA, origin at the LA's lower corner */
+typedef struct {
+    uint8_t la_id;                          // 0 = no map
+    uint8_t blocked[OBSTACLE_LA_BYTES];
+    uint8_t no_deploy[OBSTACLE_LA_BYTES];   // Includes the blocked cells
+} obstacle_la_map_t;
+
+/* LA map message, BS -> robot, sent just before the LA assignment */
+#define OBSTACLE_MSG_MAGIC0 'O'
+#define OBSTACLE_MSG_MAGIC1 'M'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t target_robot_id;
+    obstacle_la_map_t map;
+} obstacle_map_msg_t;
+
+/* Blocked and no-deploy cells of the whole target area (BS) */
+void obstacle_map_stats(uint16_t *blocked, uint16_t *no_deploy);
+
+/* Cut the LA with its lower corner at (origin_x, origin_y) metres out of the
+   whole-area map (BS). Cells outside the target area are blocked. */
+void obstacle_map_extract(uint8_t la_id, uint16_t origin_x, uint16_t origin_y,
+                          obstacle_la_map_t *la_map);
+
+/* Cell (cx, cy) of an LA map; cells outside the LA are blocked */
+uint8_t obstacle_la_blocked(const obstacle_la_map_t *la_map, int16_t cx, int16_t cy);
+
+/* 1 if a sensor can be placed at (x, y) metres from the LA origin */
+uint8_t obstacle_la_deployable(const obstacle_la_map_t *la_map, uint16_t x, uint16_t y);
+
+#endif /* OBSTACLE_MAP_H_ */
@@ -0,0 +1,239 @@
+#include "path-planner.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A* over the cells of one LA map: orthogonal steps cost 10, diagonal 14,
+   with the octile distance as heuristic. Diagonal steps may not cut the
+   corner of a blocked cell. The open set is a bitmap scanned linearly; with
+   a few hundred cells at most that is cheaper than maintaining a heap. */
+#define STEP_COST 10
+#define DIAGONAL_COST 14
+#define NO_PARENT ((obstacle_cell_t)-1)
+#define LOS_STEP (OBSTACLE_CELL / 4.0f)
+
+typedef struct {
+    uint8_t la_id;                // 0 = empty
+    uint16_t from_x;
+    uint16_t from_y;
+    uint16_t to_x;
+    uint16_t to_y;
+    float length;
+} path_cache_entry_t;
+
+static path_cache_entry_t path_cache[PATH_CACHE_SIZE];
+static uint8_t path_cache_next;   // Round-robin replacement
+static uint32_t path_cache_hits;
+static uint32_t path_cache_misses;
+
+static uint16_t g_cost[OBSTACLE_LA_CELLS];
+static obstacle_cell_t parent[OBSTACLE_LA_CELLS];
+static uint8_t open_set[OBSTACLE_LA_BYTES];
+static uint8_t closed_set[OBSTACLE_LA_BYTES];
+static obstacle_cell_t waypoints[OBSTACLE_LA_CELLS];
+
+static inline uint8_t bit_get(const uint8_t *bitmap, obstacle_cell_t index) {
+    return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline void bit_put(uint8_t *bitmap, obstacle_cell_t index, uint8_t value) {
+    if (value) {
+        bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+    } else {
+        bitmap[index >> 3] &= (uint8_t)~(1 << (index & 7));
+    }
+}
+
+/* Cell holding a point; points on the far LA edge belong to the last cell */
+static int16_t cell_of(float metres) {
+    int16_t cell = (int16_t)(metres / OBSTACLE_CELL);
+    return (cell >= OBSTACLE_LA_SIDE) ? OBSTACLE_LA_SIDE - 1 : cell;
+}
+
+static float cell_centre(uint8_t cell_coord) {
+    return (cell_coord + 0.5f) * OBSTACLE_CELL;
+}
+
+typedef struct {
+    float x;
+    float y;
+} point_t;
+
+static float distance(point_t a, point_t b) {
+    return sqrtf((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+}
+
+/* Segment clear of blocked cells, sampled every quarter cell */
+static uint8_t line_of_sight(const obstacle_la_map_t *la_map, point_t a, point_t b) {
+    uint16_t steps = (uint16_t)(distance(a, b) / LOS_STEP) + 1;
+    
+    for (uint16_t i = 0; i <= steps; i++) {
+        float t = (float)i / steps;
+        if (obstacle_la_blocked(la_map, cell_of(a.x + (b.x - a.x) * t), cell_of(a.y + (b.y - a.y) * t))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint16_t octile(obstacle_cell_t a, obstacle_cell_t b) {
+    uint8_t dx = abs(a % OBSTACLE_LA_SIDE - b % OBSTACLE_LA_SIDE);
+    uint8_t dy = abs(a / OBSTACLE_LA_SIDE - b / OBSTACLE_LA_SIDE);
+    uint8_t lo = (dx < dy) ? dx : dy;
+    uint8_t hi = (dx < dy) ? dy : dx;
+    return STEP_COST * hi + (DIAGONAL_COST - STEP_COST) * lo;
+}
+
+/* Fills parent[] from start to goal; 0 if the goal is unreachable. Any step
+   out of a blocked cell is allowed, so a robot left standing on rubble (e.g.
+   at an LA centre inside a collapsed building) climbs out the shortest way. */
+static uint8_t astar(const obstacle_la_map_t *la_map, obstacle_cell_t start, obstacle_cell_t goal) {
+    memset(open_set, 0, sizeof(open_set));
+    memset(closed_set, 0, sizeof(closed_set));
+    g_cost[start] = 0;
+    parent[start] = NO_PARENT;
+    bit_put(open_set, start, 1);
+    
+    while (1) {
+        uint16_t best_f = 0xFFFF;
+        int16_t current = -1;
+        
+        for (obstacle_cell_t i = 0; i < OBSTACLE_LA_CELLS; i++) {
+            if (bit_get(open_set, i) && g_cost[i] + octile(i, goal) < best_f) {
+                best_f = g_cost[i] + octile(i, goal);
+                current = i;
+            }
+        }
+        if (current < 0) {
+            return 0;
+        }
+        if (current == goal) {
+            return 1;
+        }
+        bit_put(open_set, current, 0);
+        bit_put(closed_set, current, 1);
+        
+        int16_t cx = current % OBSTACLE_LA_SIDE;
+        int16_t cy = current / OBSTACLE_LA_SIDE;
+        uint8_t escaping = obstacle_la_blocked(la_map, cx, cy);
+        for (int8_t dy = -1; dy <= 1; dy++) {
+            for (int8_t dx = -1; dx <= 1; dx++) {
+                int16_t nx = cx + dx;
+                int16_t ny = cy + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 ||
+                    nx >= OBSTACLE_LA_SIDE || ny >= OBSTACLE_LA_SIDE) {
+                    continue;
+                }
+                if (!escaping && (obstacle_la_blocked(la_map, nx, ny) ||
+                                  (dx != 0 && dy != 0 && (obstacle_la_blocked(la_map, nx, cy) ||
+                                                          obstacle_la_blocked(la_map, cx, ny))))) {
+                    continue;
+                }
+                obstacle_cell_t next = ny * OBSTACLE_LA_SIDE + nx;
+                uint16_t cost = g_cost[current] + ((dx != 0 && dy != 0) ? DIAGONAL_COST : STEP_COST);
+                if (bit_get(closed_set, next) || (bit_get(open_set, next) && cost >= g_cost[next])) {
+                    continue;
+                }
+                g_cost[next] = cost;
+                parent[next] = current;
+                bit_put(open_set, next, 1);
+            }
+        }
+    }
+}
+
+/* Point i of the A* path: 0 is the start point, count + 1 the goal point and
+   i in between the centre of path cell waypoints[i - 1] */
+static point_t waypoint(obstacle_cell_t i, obstacle_cell_t count, point_t from, point_t to) {
+    point_t p;
+    
+    if (i == 0) {
+        return from;
+    }
+    if (i == count + 1) {
+        return to;
+    }
+    p.x = cell_centre(waypoints[i - 1] % OBSTACLE_LA_SIDE);
+    p.y = cell_centre(waypoints[i - 1] / OBSTACLE_LA_SIDE);
+    return p;
+}
+
+static float plan(const obstacle_la_map_t *la_map, point_t from, point_t to) {
+    obstacle_cell_t start = cell_of(from.y) * OBSTACLE_LA_SIDE + cell_of(from.x);
+    obstacle_cell_t goal = cell_of(to.y) * OBSTACLE_LA_SIDE + cell_of(to.x);
+    obstacle_cell_t count = 0;
+    float length = 0.0f;
+    
+    if (line_of_sight(la_map, from, to)) {
+        return distance(from, to);
+    }
+    if (obstacle_la_blocked(la_map, goal % OBSTACLE_LA_SIDE, goal / OBSTACLE_LA_SIDE) ||
+        !astar(la_map, start, goal)) {
+        return -1.0f;
+    }
+    
+    /* Cells strictly between start and goal, in travel order */
+    for (obstacle_cell_t cell = parent[goal]; cell != start; cell = parent[cell]) {
+        count++;
+    }
+    obstacle_cell_t i = count;
+    for (obstacle_cell_t cell = parent[goal]; cell != start; cell = parent[cell]) {
+        waypoints[--i] = cell;
+    }
+    
+    /* String pulling: from each anchor go straight to the furthest waypoint
+       in sight; the next waypoint always is, being a neighbouring cell */
+    point_t anchor = from;
+    obstacle_cell_t at = 0;
+    while (at <= count) {
+        obstacle_cell_t next = count + 1;
+        point_t target = to;
+        while (next > at + 1 && !line_of_sight(la_map, anchor, target)) {
+            target = waypoint(--next, count, from, to);
+        }
+        length += distance(anchor, target);
+        anchor = target;
+        at = next;
+    }
+    return length;
+}
+
+float path_plan_length(const obstacle_la_map_t *la_map, uint16_t from_x, uint16_t from_y,
+                       uint16_t to_x, uint16_t to_y) {
+    path_cache_entry_t *entry;
+    point_t from, to;
+    
+    for (uint8_t i = 0; i < PATH_CACHE_SIZE; i++) {
+        entry = &path_cache[i];
+        if (entry->la_id != la_map->la_id || entry->la_id == 0) {
+            continue;
+        }
+        if ((entry->from_x == from_x && entry->from_y == from_y &&
+             entry->to_x == to_x && entry->to_y == to_y) ||
+            (entry->from_x == to_x && entry->from_y == to_y &&
+             entry->to_x == from_x && entry->to_y == from_y)) {
+            path_cache_hits++;
+            return entry->length;
+        }
+    }
+    
+    path_cache_misses++;
+    entry = &path_cache[path_cache_next];
+    path_cache_next = (path_cache_next + 1) % PATH_CACHE_SIZE;
+    entry->la_id = la_map->la_id;
+    entry->from_x = from_x;
+    entry->from_y = from_y;
+    entry->to_x = to_x;
+    entry->to_y = to_y;
+    from.x = from_x;
+    from.y = from_y;
+    to.x = to_x;
+    to.y = to_y;
+    entry->length = plan(la_map, from, to);
+    return entry->length;
+}
+
+void path_cache_stats(uint32_t *hits, uint32_t *misses) {
+    *hits = path_cache_hits;
+    *misses = path_cache_misses;
+}
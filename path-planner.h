@@ -0,0 +1,18 @@
+#ifndef PATH_PLANNER_H_
+#define PATH_PLANNER_H_
+
+#include <stdint.h>
+#include "obstacle-map.h"
+
+/* Length in metres of the shortest obstacle-free route between two points
+   of an LA, in metres from the LA origin; negative if the goal cannot be
+   reached. A straight line is used when nothing blocks it, otherwise an
+   8-connected A* path over the map cells, smoothed by cutting corners that
+   have a clear line of sight. The last PATH_CACHE_SIZE results are cached. */
+float path_plan_length(const obstacle_la_map_t *la_map, uint16_t from_x, uint16_t from_y,
+                       uint16_t to_x, uint16_t to_y);
+
+/* Cache lookups answered without planning, and plans computed */
+void path_cache_stats(uint32_t *hits, uint32_t *misses);
+
+#endif /* PATH_PLANNER_H_ */
@@ -0,0 +1,39 @@
+#include "profile-scope.h"
+
+#include "node-shell.h"
+#include "sys/log.h"
+#define LOG_MODULE "Profile"
+#define LOG_LEVEL app_log_level
+
+uint32_t profile_ticks_to_us(uint32_t ticks) {
+    return (uint32_t)(((uint64_t)ticks * 1000000) / RTIMER_SECOND);
+}
+
+void profile_scope_record(profile_scope_t *scope, rtimer_clock_t elapsed) {
+    scope->calls++;
+    scope->total_ticks += elapsed;
+    if (elapsed > scope->max_ticks) {
+        scope->max_ticks = elapsed;
+    }
+}
+
+void profile_scope_reset(profile_scope_t *scope) {
+    scope->calls = 0;
+    scope->total_ticks = 0;
+    scope->max_ticks = 0;
+}
+
+void profile_report_log(const char *node, uint8_t node_id,
+                        profile_scope_t *const *scopes, uint8_t num_scopes) {
+    LOG_INFO("=== PROFILE REPORT %s %u ===\n", node, node_id);
+    LOG_INFO("scope, calls, total_us, avg_us, max_us\n");
+    for (uint8_t i = 0; i < num_scopes; i++) {
+        const profile_scope_t *scope = scopes[i];
+        uint32_t total_us = profile_ticks_to_us(scope->total_ticks);
+        LOG_INFO("%s, %lu, %lu, %lu, %lu\n", scope->name,
+                 (unsigned long)scope->calls, (unsigned long)total_us,
+                 (unsigned long)(scope->calls ? total_us / scope->calls : 0),
+                 (unsigned long)profile_ticks_to_us(scope->max_ticks));
+    }
+    LOG_INFO("=============================\n");
+}
@@ -0,0 +1,33 @@
+#ifndef PROFILE_SCOPE_H_
+#define PROFILE_SCOPE_H_
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include <stdint.h>
+
+/* Lightweight instrumentation scope: rtimer-tick totals, call count and max */
+typedef struct {
+    const char *name;
+    uint32_t calls;
+    uint32_t total_ticks;
+    rtimer_clock_t max_ticks;
+} profile_scope_t;
+
+#define PROFILE_SCOPE_INIT(scope_name) { scope_name, 0, 0, 0 }
+
+/* Time a single statement or call against a scope */
+#define PROFILE_CALL(scope, call) do {                          \
+        rtimer_clock_t profile_start_ = RTIMER_NOW();           \
+        call;                                                   \
+        profile_scope_record(&(scope), RTIMER_NOW() - profile_start_); \
+    } while(0)
+
+uint32_t profile_ticks_to_us(uint32_t ticks);
+void profile_scope_record(profile_scope_t *scope, rtimer_clock_t elapsed);
+void profile_scope_reset(profile_scope_t *scope);
+
+/* Log one structured report covering all scopes of a node */
+void profile_report_log(const char *node, uint8_t node_id,
+                        profile_scope_t *const *scopes, uint8_t num_scopes);
+
+#endif /* PROFILE_SCOPE_H_ */
@@ -6,11 +6,16 @@
 #define UDP_CLIENT_PORT 8765
 
 /* Base Station Configuration */
-#define MAX_LOCATION_AREAS 20
-#define MAX_ROBOTS 2
+#ifndef MAX_LOCATION_AREAS
+#define MAX_LOCATION_AREAS 20        // Override (e.g. DEFINES=MAX_LOCATION_AREAS=1) for single-LA runs
+#endif
+#ifndef MAX_ROBOTS
+#define MAX_ROBOTS 2                 // Override (e.g. DEFINES=MAX_ROBOTS=202) for fleet load tests
+#endif
 #define MAX_SENSORS_PER_AREA 50
 #define ROBOT_STOCK_CAPACITY 15
 #define ROBOT_INITIAL_STOCK 10
+#define SENSOR_SPILL_POOL_SIZE 100   // Compact overflow records once Sensor_DB is full
 
 /* Energy Model Parameters */
 /* Base Station Energy Parameters */
@@ -31,6 +36,7 @@
 #define P_RECEIVE_SENSOR 0.025       // Sensor receive power in Watts
 #define P_PROCESSING_SENSOR 0.015    // Sensor processing power in Watts
 #define MU_SENSING 0.0005           // Energy coefficient for sensing field
+#define SENSOR_BATTERY_CAPACITY 18720.0  // Two AA cells in Joules (lifetime mode residual energy)
 
 /* Target Area Configuration */
 #define TARGET_AREA_WIDTH 1000       // Target area width in meters
@@ -42,7 +48,87 @@
 #define MESSAGE_SEND_INTERVAL (30 * CLOCK_SECOND)
 #define ENERGY_REPORT_INTERVAL (60 * CLOCK_SECOND)
 
+/* Base Station Checkpoint Configuration */
+#define BS_CHECKPOINT_ENABLED 1              // Persist LA_DB/Robot_DB deltas to flash (CFS)
+#define BS_CHECKPOINT_COMPACT_THRESHOLD 64   // Log records before compacting into a snapshot
+
+/* Base Station CoAP Metrics */
+#define BS_COAP_METRICS_ENABLED 1            // Observable CBOR metrics resources on the BS
+#define COAP_MAX_CHUNK_SIZE 64               // Block-wise transfer size for metrics payloads
+
+/* Mobile Robot Journal Configuration */
+#define ROBOT_JOURNAL_ENABLED 1              // Journal local-phase progress to flash (CFS)
+#define ROBOT_RESUME_RETRY_INTERVAL (2 * CLOCK_SECOND)   // Robot_RM resend period until the BS acks
+
+/* Sensor Swarm Firmware (one mote emulating many logical sensors) */
+#define SWARM_NUM_SENSORS 20                 // Logical sensors per swarm mote
+#define SWARM_MAX_MOTES 4                    // Swarm motes with distinct ID blocks
+#define SWARM_ID_BASE 100                    // First logical sensor ID
+#define SWARM_REPLY_DELAY (CLOCK_SECOND / 20)   // Minimum reply latency
+#define SWARM_REPLY_JITTER (CLOCK_SECOND / 2)   // Random extra reply latency
+
+/* Robot Fleet Load Generator (virtual robots driving the BS scheduler) */
+#define FLEET_NUM_ROBOTS 200                 // Virtual robots impersonated by one mote
+#define FLEET_FIRST_ROBOT_ID 2               // Leaves IDs 0 and 1 to the real robots
+#define FLEET_RATE_START 1                   // Offered messages/s in the first step
+#define FLEET_RATE_MAX 128                   // Last step; the rate doubles per step
+#define FLEET_STEP_DURATION (30 * CLOCK_SECOND)
+#define FLEET_SEND_TICK (CLOCK_SECOND / 16)
+#define FLEET_MAX_BURST 16                   // Messages sent per tick at most
+#define FLEET_HEARTBEAT_PERCENT 25           // Share of busy robots' messages sent as progress heartbeats
+#define FLEET_REPORT_GRIDS 0                 // Covered grids per report (0 keeps LAs schedulable)
+#define FLEET_REPLY_TIMEOUT (5 * CLOCK_SECOND)
+
+/* Radio Record/Replay (set from the Makefile: RADIO_TRACE=1, RADIO_REPLAY=1) */
+#ifndef RADIO_TRACE_ENABLED
+#define RADIO_TRACE_ENABLED 0                // Print every delivered datagram as an RTRACE line
+#endif
+#ifndef RADIO_REPLAY_ENABLED
+#define RADIO_REPLAY_ENABLED 0               // Native only: feed a binary trace into udp_rx_callback
+#endif
+#define RADIO_REPLAY_DRAIN (30 * CLOCK_SECOND)  // Run on after the last replayed record
+
+/* Obstacle Map and Robot Path Planning (map: obstacle-map.txt -> tools/obstacle-map.py) */
+#ifndef OBSTACLE_MAP_ENABLED
+#define OBSTACLE_MAP_ENABLED 1               // BS sends each robot its LA's obstacle map
+#endif
+#define OBSTACLE_CELL 10                     // Map cell side in metres
+#define PATH_CACHE_SIZE 8                    // Planned path lengths cached per robot
+
+/* Sleep Rotation of Redundant Sensors (robot, per LA after dispersion) */
+#define SLEEP_SCHEDULING_ENABLED 1           // Rotate k-covered random sensors through sleep
+#define SLEEP_K_COVERAGE 2                   // Coverage by awake sensors needed to sleep
+#define SLEEP_RASTER_CELL 5                  // Redundancy raster cell side in metres
+#define SLEEP_ROTATION_SLOTS 4               // A scheduled sensor is awake one slot in this many
+#define SLEEP_SLOT_DURATION (60 * CLOCK_SECOND)
+
+/* Batched Grid Commands to Sensors (robot -> sensors, one frame per grid) */
+#define SENSOR_CMD_MAX_ENTRIES 16            // Collect/activate/relocate entries per frame
+#define SENSOR_CMD_ACK_TIMEOUT (CLOCK_SECOND / 2)   // Wait for acks before rebroadcasting
+#define SENSOR_CMD_RETRIES 2                 // Rebroadcasts while entries are unacked
+
+/* Lifetime Simulation (native lifetime-sim) */
+#define LIFETIME_MAX_SENSORS 16384           // Sensors in one deployment outcome
+#define LIFETIME_RANDOM_SENSORS 100          // Random sensors added to the generated APP_I outcome
+#define LIFETIME_COVERAGE_THRESHOLD 90.0     // Per_AC (%) below which coverage counts as lost
+#define LIFETIME_SAMPLE_INTERVAL 21600       // Seconds between Per_AC curve samples (6 h)
+#define LIFETIME_MAX_DAYS 365                // Simulation horizon
+
+/* Geometric Coverage Raster (native lifetime-sim) */
+#define COVERAGE_RASTER_CELL 1               // Cell side in metres
+#define COVERAGE_RASTER_LEVELS 3             // k-coverage tracked up to this k
+
+/* Runtime Shell */
+#define NODE_SHELL_ENABLED 1                 // Inspection commands on the serial shell
+
 /* Logging */
 #define LOG_LEVEL_APP LOG_LEVEL_INFO
 
+/* Deferred log queue for radio callbacks (robot and sensor) */
+#define LOG_QUEUE_SIZE 16                    // Pending events
+#define LOG_QUEUE_MAX_TYPES 12               // Event types per node
+#define LOG_QUEUE_RATE_LIMIT 5               // Events per type per window
+#define LOG_QUEUE_RATE_WINDOW (CLOCK_SECOND) // Rate limiting window
+#define LOG_QUEUE_DRAIN_BATCH 4              // Events printed per process turn
+
 #endif /* PROJECT_CONF_H_ */
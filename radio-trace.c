@@ -0,0 +1,208 @@
+#include "radio-trace.h"
+#include "node-shell.h"
+#include "net/linkaddr.h"
+#include "sys/node-id.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "RadioTrace"
+#define LOG_LEVEL app_log_level
+
+#if RADIO_TRACE_ENABLED || RADIO_REPLAY_ENABLED
+/* Cooja IPv6 motes have a zero first link-layer byte, so records are
+   tagged with node_id, falling back to the link-layer address if unset */
+static uint8_t radio_trace_node_id(void) {
+    return node_id != 0 ? (uint8_t)node_id : linkaddr_node_addr.u8[0];
+}
+
+static uint8_t radio_trace_flags(const uip_ipaddr_t *dst) {
+    return (dst != NULL && dst->u8[0] == 0xff) ? RADIO_TRACE_FLAG_MULTICAST : 0;
+}
+#endif
+
+#if RADIO_TRACE_ENABLED
+static void print_hex(const uint8_t *bytes, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        printf("%02x", bytes[i]);
+    }
+}
+
+static void put_le16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+void radio_trace_record(const uip_ipaddr_t *src, uint16_t src_port,
+                        const uip_ipaddr_t *dst, uint16_t dst_port,
+                        const uint8_t *data, uint16_t datalen) {
+    uint32_t time_ms = (uint32_t)(((uint64_t)clock_time() * 1000) / CLOCK_SECOND);
+    uint8_t header[RADIO_TRACE_RECORD_HEADER_LEN];
+    uint8_t flags = radio_trace_flags(dst);
+    
+    if (datalen > RADIO_TRACE_MAX_PAYLOAD) {
+        datalen = RADIO_TRACE_MAX_PAYLOAD;
+        flags |= RADIO_TRACE_FLAG_TRUNCATED;
+    }
+    put_le16(&header[0], time_ms & 0xFFFF);
+    put_le16(&header[2], time_ms >> 16);
+    header[4] = radio_trace_node_id();
+    header[5] = flags;
+    put_le16(&header[6], datalen);
+    put_le16(&header[8], src_port);
+    put_le16(&header[10], dst_port);
+    memcpy(&header[12], src->u8, 16);
+    if (dst != NULL) {
+        memcpy(&header[28], dst->u8, 16);
+    } else {
+        memset(&header[28], 0, 16);
+    }
+    
+    /* Raw printf: the trace must not depend on the runtime log level */
+    printf("RTRACE ");
+    print_hex(header, sizeof(header));
+    print_hex(data, datalen);
+    printf("\n");
+}
+#endif /* RADIO_TRACE_ENABLED */
+
+#if RADIO_REPLAY_ENABLED
+
+static struct {
+    FILE *file;
+    uint8_t node;                       // Records for this node only, 0 = all
+    struct simple_udp_connection *conn;
+    simple_udp_callback rx_callback;
+    void (*done)(void);
+    
+    /* Next record to deliver */
+    clock_time_t due;                   // Recorded delivery time since boot
+    uint16_t src_port;
+    uint16_t dst_port;
+    uip_ipaddr_t src;
+    uip_ipaddr_t dst;
+    uint16_t len;
+    uint8_t payload[RADIO_TRACE_MAX_PAYLOAD];
+    
+    uint32_t delivered;
+    uint32_t skipped;
+    uint32_t truncated;
+    uint32_t late;                      // Delivered after their recorded time
+    uint32_t sends;
+    uint32_t send_bytes;
+} replay;
+
+static struct etimer replay_timer;
+
+PROCESS(radio_replay_process, "Radio Replay Process");
+
+int radio_replay_sendto(struct simple_udp_connection *c, const void *data,
+                        uint16_t datalen, const uip_ipaddr_t *to) {
+    replay.sends++;
+    replay.send_bytes += datalen;
+    return 0;
+}
+
+static uint16_t get_le16(const uint8_t *in) {
+    return in[0] | (in[1] << 8);
+}
+
+/* Read the next record for this node into replay; returns 0 at end of trace */
+static uint8_t replay_read_record(void) {
+    uint8_t header[RADIO_TRACE_RECORD_HEADER_LEN];
+    
+    while (fread(header, 1, sizeof(header), replay.file) == sizeof(header)) {
+        uint32_t time_ms = get_le16(&header[0]) | ((uint32_t)get_le16(&header[2]) << 16);
+        
+        replay.len = get_le16(&header[6]);
+        if (replay.len > sizeof(replay.payload) ||
+            fread(replay.payload, 1, replay.len, replay.file) != replay.len) {
+            LOG_ERR("Truncated trace record\n");
+            return 0;
+        }
+        if (replay.node != 0 && header[4] != replay.node) {
+            replay.skipped++;
+            continue;
+        }
+        if (header[5] & RADIO_TRACE_FLAG_TRUNCATED) {
+            /* Only a prefix was recorded: delivering it would be a different datagram */
+            replay.truncated++;
+            continue;
+        }
+        
+        replay.due = (clock_time_t)(((uint64_t)time_ms * CLOCK_SECOND) / 1000);
+        replay.src_port = get_le16(&header[8]);
+        replay.dst_port = get_le16(&header[10]);
+        memcpy(replay.src.u8, &header[12], 16);
+        memcpy(replay.dst.u8, &header[28], 16);
+        return 1;
+    }
+    return 0;
+}
+
+void radio_replay_start(struct simple_udp_connection *conn, simple_udp_callback rx_callback,
+                        void (*done)(void)) {
+    const char *path = getenv("RADIO_REPLAY_FILE");
+    const char *node = getenv("RADIO_REPLAY_NODE");
+    uint8_t header[RADIO_TRACE_FILE_HEADER_LEN];
+    
+    memset(&replay, 0, sizeof(replay));
+    replay.conn = conn;
+    replay.rx_callback = rx_callback;
+    replay.done = done;
+    replay.node = node != NULL ? (uint8_t)atoi(node) : radio_trace_node_id();
+    
+    replay.file = fopen(path != NULL ? path : "radio.trace", "rb");
+    if (replay.file == NULL ||
+        fread(header, 1, sizeof(header), replay.file) != sizeof(header) ||
+        memcmp(header, RADIO_TRACE_MAGIC, 4) != 0 || header[4] != RADIO_TRACE_VERSION) {
+        LOG_ERR("Cannot open radio trace %s (version %u expected)\n",
+                path != NULL ? path : "radio.trace", RADIO_TRACE_VERSION);
+        exit(1);
+    }
+    
+    LOG_INFO("Replaying radio trace for node %u\n", replay.node);
+    process_start(&radio_replay_process, NULL);
+}
+
+PROCESS_THREAD(radio_replay_process, ev, data) {
+    PROCESS_BEGIN();
+    
+    /* Deliver each record at its recorded offset from boot, so the node's own
+       timers (discovery, phase, ack timeouts) fire between deliveries as they
+       did on the radio. Records already due still yield once in between. */
+    while (replay_read_record()) {
+        if (replay.due > clock_time()) {
+            etimer_set(&replay_timer, replay.due - clock_time());
+            PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &replay_timer);
+        } else {
+            replay.late += (replay.due < clock_time());
+            process_poll(&radio_replay_process);
+            PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+        }
+        replay.rx_callback(replay.conn, &replay.src, replay.src_port,
+                           &replay.dst, replay.dst_port, replay.payload, replay.len);
+        replay.delivered++;
+    }
+    fclose(replay.file);
+    
+    /* Periodic timers never drain, so run on for a fixed tail instead */
+    LOG_INFO("Trace exhausted, running on for %lu s\n",
+             (unsigned long)(RADIO_REPLAY_DRAIN / CLOCK_SECOND));
+    etimer_set(&replay_timer, RADIO_REPLAY_DRAIN);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &replay_timer);
+    
+    LOG_INFO("Replay complete: %lu delivered (%lu late), %lu skipped, %lu truncated, "
+             "%lu sends (%lu bytes)\n",
+             (unsigned long)replay.delivered, (unsigned long)replay.late,
+             (unsigned long)replay.skipped, (unsigned long)replay.truncated,
+             (unsigned long)replay.sends, (unsigned long)replay.send_bytes);
+    if (replay.done != NULL) {
+        replay.done();
+    }
+    exit(0);
+    
+    PROCESS_END();
+}
+#endif /* RADIO_REPLAY_ENABLED */
@@ -0,0 +1,59 @@
+#ifndef RADIO_TRACE_H_
+#define RADIO_TRACE_H_
+
+#include "contiki.h"
+#include "net/ipv6/simple-udp.h"
+#include "project-conf.h"
+#include <stdint.h>
+
+/* Radio event record/replay.
+   Recording (RADIO_TRACE_ENABLED): every datagram delivered to a node's
+   udp_rx_callback is printed as one "RTRACE" hex line; tools/rtrace.py
+   turns a log into a binary trace.
+   Replay (RADIO_REPLAY_ENABLED, native target): the trace is read back and
+   fed into the node's callback at the recorded times, with sends counted
+   instead of transmitted. */
+
+/* Binary trace layout (little-endian):
+   file header: magic "RTRC", version, 3 reserved bytes
+   record:      time_ms u32, node u8, flags u8, len u16, src_port u16,
+                dst_port u16, src[16], dst[16], payload[len]
+   node is the receiver's node_id (the Cooja mote ID), or the first
+   link-layer address byte where node_id is unset.
+   len is the stored payload; a truncated record keeps only the first
+   RADIO_TRACE_MAX_PAYLOAD bytes and is skipped on replay. */
+#define RADIO_TRACE_MAGIC "RTRC"
+#define RADIO_TRACE_VERSION 2
+#define RADIO_TRACE_FILE_HEADER_LEN 8
+#define RADIO_TRACE_RECORD_HEADER_LEN 44
+#define RADIO_TRACE_MAX_PAYLOAD 128
+
+#define RADIO_TRACE_FLAG_MULTICAST 0x01   // Delivered via a multicast destination
+#define RADIO_TRACE_FLAG_TRUNCATED 0x02   // Datagram longer than RADIO_TRACE_MAX_PAYLOAD
+
+#if RADIO_TRACE_ENABLED
+void radio_trace_record(const uip_ipaddr_t *src, uint16_t src_port,
+                        const uip_ipaddr_t *dst, uint16_t dst_port,
+                        const uint8_t *data, uint16_t datalen);
+#else
+#define radio_trace_record(src, src_port, dst, dst_port, data, datalen)
+#endif /* RADIO_TRACE_ENABLED */
+
+#if RADIO_REPLAY_ENABLED
+/* Feed the trace named by $RADIO_REPLAY_FILE (default "radio.trace") into
+   rx_callback, each record at its recorded time since boot; records from
+   other nodes are skipped unless $RADIO_REPLAY_NODE is 0. Once the trace is
+   exhausted the node runs on for RADIO_REPLAY_DRAIN so the timers the last
+   deliveries armed still fire, then done is called and the process exits. */
+void radio_replay_start(struct simple_udp_connection *conn, simple_udp_callback rx_callback,
+                        void (*done)(void));
+
+/* Replayed nodes must not reach the radio: count sends instead */
+int radio_replay_sendto(struct simple_udp_connection *c, const void *data,
+                        uint16_t datalen, const uip_ipaddr_t *to);
+#define simple_udp_sendto(c, data, datalen, to) radio_replay_sendto(c, data, datalen, to)
+#else
+#define radio_replay_start(conn, rx_callback, done)
+#endif /* RADIO_REPLAY_ENABLED */
+
+#endif /* RADIO_TRACE_H_ */
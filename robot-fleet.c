@@ -0,0 +1,276 @@
+#include "contiki.h"
+#include "net/routing/routing.h"
+#include "net/netstack.h"
+#include "net/ipv6/simple-udp.h"
+#include "sys/etimer.h"
+#include "sys/clock.h"
+#include "random.h"
+#include "project-conf.h"
+#include "latency-histogram.h"
+#include "node-shell.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "RobotFleet"
+#define LOG_LEVEL app_log_level
+
+/* Load generator impersonating FLEET_NUM_ROBOTS robots towards the base
+   station. Offered load starts at FLEET_RATE_START messages/s and doubles
+   every FLEET_STEP_DURATION up to FLEET_RATE_MAX. Each step ends with one
+   FLEET_CURVE line: offered rate, messages sent, assignments received,
+   achieved assignment throughput and report->assignment latency. */
+
+/* Message structures (same wire format as mobile-robot.c / base-station.c) */
+typedef struct {
+    uint8_t robot_id;
+    uint8_t covered_grids;
+} robot_report_msg_t;
+
+/* Robot_HM: progress heartbeat of a robot busy on an LA */
+#define HEARTBEAT_MSG_MAGIC0 'R'
+#define HEARTBEAT_MSG_MAGIC1 'H'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t la_id;
+    uint8_t covered_grids;
+} robot_heartbeat_msg_t;
+
+typedef struct {
+    uint8_t la_id;
+    uint16_t center_x;
+    uint16_t center_y;
+    uint8_t no_grid;
+} la_assignment_msg_t;
+
+typedef struct {
+    uint8_t target_robot_id;
+    la_assignment_msg_t la_assignment;
+} robot_assignment_msg_t;
+
+/* Virtual robot state */
+typedef struct {
+    uint8_t assigned_la_id;
+    uint8_t next_grid;
+    clock_time_t report_sent_time;  // 0 when no report is outstanding
+} virtual_robot_t;
+
+/* Per-step counters */
+typedef struct {
+    uint32_t reports;
+    uint32_t heartbeats;
+    uint32_t replies;
+    uint32_t unexpected;   // Assignments for robots with no outstanding report
+    uint32_t timeouts;     // Reports left unanswered for FLEET_REPLY_TIMEOUT
+} fleet_step_stats_t;
+
+/* Robot Fleet State */
+static struct {
+    virtual_robot_t robots[FLEET_NUM_ROBOTS];
+    uint8_t next_robot;        // Round-robin cursor
+    uint16_t rate;             // Offered messages per second in this step
+    uint8_t step;
+    uint32_t credit;           // Send credit in messages * CLOCK_SECOND
+    fleet_step_stats_t stats;
+    clock_time_t step_start;
+    
+    /* Communication */
+    uip_ipaddr_t base_station_addr;
+    uint8_t bs_reachable;
+    uint8_t done;
+} fleet;
+
+static latency_hist_t hist_step;  // Report -> assignment within the current step
+
+static struct simple_udp_connection udp_conn;
+static struct etimer send_timer;
+static struct etimer step_timer;
+
+PROCESS(robot_fleet_process, "Robot Fleet Process");
+AUTOSTART_PROCESSES(&robot_fleet_process);
+
+static uint8_t fleet_robot_id(uint8_t index) {
+    return FLEET_FIRST_ROBOT_ID + index;
+}
+
+/* Send one message for the next robot: a progress heartbeat if it is busy
+   on an LA, otherwise a coverage report asking for the next assignment */
+static void send_next_message() {
+    uint8_t index = fleet.next_robot;
+    virtual_robot_t *robot = &fleet.robots[index];
+    
+    fleet.next_robot = (fleet.next_robot + 1) % FLEET_NUM_ROBOTS;
+    
+    if (robot->report_sent_time != 0 &&
+        clock_time() - robot->report_sent_time > FLEET_REPLY_TIMEOUT) {
+        fleet.stats.timeouts++;
+        robot->report_sent_time = 0;
+    }
+    
+    if (robot->assigned_la_id != 0 && random_rand() % 100 < FLEET_HEARTBEAT_PERCENT) {
+        robot_heartbeat_msg_t heartbeat;
+        heartbeat.magic[0] = HEARTBEAT_MSG_MAGIC0;
+        heartbeat.magic[1] = HEARTBEAT_MSG_MAGIC1;
+        heartbeat.robot_id = fleet_robot_id(index);
+        heartbeat.la_id = robot->assigned_la_id;
+        heartbeat.covered_grids = ++robot->next_grid;
+        simple_udp_sendto(&udp_conn, &heartbeat, sizeof(heartbeat), &fleet.base_station_addr);
+        fleet.stats.heartbeats++;
+    } else if (robot->report_sent_time == 0) {
+        robot_report_msg_t report;
+        report.robot_id = fleet_robot_id(index);
+        report.covered_grids = FLEET_REPORT_GRIDS;
+        simple_udp_sendto(&udp_conn, &report, sizeof(report), &fleet.base_station_addr);
+        robot->report_sent_time = clock_time();
+        robot->assigned_la_id = 0;
+        fleet.stats.reports++;
+    }
+}
+
+static void udp_rx_callback(struct simple_udp_connection *c,
+                           const uip_ipaddr_t *sender_addr,
+                           uint16_t sender_port,
+                           const uip_ipaddr_t *receiver_addr,
+                           uint16_t receiver_port,
+                           const uint8_t *data,
+                           uint16_t datalen) {
+    
+    if (datalen != sizeof(robot_assignment_msg_t)) {
+        return;
+    }
+    
+    const robot_assignment_msg_t *assignment = (const robot_assignment_msg_t *)data;
+    uint8_t index = assignment->target_robot_id - FLEET_FIRST_ROBOT_ID;
+    
+    if (assignment->target_robot_id < FLEET_FIRST_ROBOT_ID || index >= FLEET_NUM_ROBOTS) {
+        return; // Addressed to a real robot
+    }
+    
+    virtual_robot_t *robot = &fleet.robots[index];
+    if (robot->report_sent_time == 0) {
+        fleet.stats.unexpected++;
+        return;
+    }
+    
+    latency_hist_record(&hist_step, clock_time() - robot->report_sent_time);
+    robot->report_sent_time = 0;
+    robot->assigned_la_id = assignment->la_assignment.la_id;
+    robot->next_grid = 0;
+    fleet.stats.replies++;
+}
+
+static void start_step() {
+    memset(&fleet.stats, 0, sizeof(fleet.stats));
+    latency_hist_reset(&hist_step);
+    fleet.credit = 0;
+    fleet.step_start = clock_time();
+    etimer_set(&step_timer, FLEET_STEP_DURATION);
+}
+
+static void report_step() {
+    clock_time_t elapsed = clock_time() - fleet.step_start;
+    uint32_t throughput_milli = elapsed ? (fleet.stats.replies * 1000UL * CLOCK_SECOND) / elapsed : 0;
+    
+    LOG_INFO("FLEET_CURVE, %u, %u, %lu, %lu, %lu, %lu, %lu, %lu.%03lu, %lu, %lu, %lu, %lu\n",
+             fleet.step, fleet.rate,
+             (unsigned long)fleet.stats.reports, (unsigned long)fleet.stats.heartbeats,
+             (unsigned long)fleet.stats.replies, (unsigned long)fleet.stats.unexpected,
+             (unsigned long)fleet.stats.timeouts,
+             (unsigned long)(throughput_milli / 1000), (unsigned long)(throughput_milli % 1000),
+             (unsigned long)latency_hist_percentile(&hist_step, 50),
+             (unsigned long)latency_hist_percentile(&hist_step, 90),
+             (unsigned long)latency_hist_percentile(&hist_step, 99), (unsigned long)hist_step.max_ms);
+}
+
+/* Shell Commands (live inspection over the serial console) */
+#if NODE_SHELL_ENABLED
+static PT_THREAD(cmd_fleet(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Step %u, offered %u msg/s, robots %u-%u\n", fleet.step, fleet.rate,
+                 fleet_robot_id(0), fleet_robot_id(FLEET_NUM_ROBOTS - 1));
+    SHELL_OUTPUT(output, "reports %lu, heartbeats %lu, replies %lu, unexpected %lu, timeouts %lu\n",
+                 (unsigned long)fleet.stats.reports, (unsigned long)fleet.stats.heartbeats,
+                 (unsigned long)fleet.stats.replies, (unsigned long)fleet.stats.unexpected,
+                 (unsigned long)fleet.stats.timeouts);
+    
+    PT_END(pt);
+}
+
+static const struct shell_command_t fleet_shell_commands[] = {
+    { "fleet", cmd_fleet, "'> fleet': Show the current load step counters" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t fleet_shell_command_set = {
+    .next = NULL,
+    .commands = fleet_shell_commands,
+};
+#endif /* NODE_SHELL_ENABLED */
+
+PROCESS_THREAD(robot_fleet_process, ev, data) {
+    PROCESS_BEGIN();
+    
+    memset(&fleet, 0, sizeof(fleet));
+    fleet.rate = FLEET_RATE_START;
+    latency_hist_init(&hist_step, "fleet report->assign");
+    
+    simple_udp_register(&udp_conn, UDP_CLIENT_PORT, NULL, UDP_SERVER_PORT, udp_rx_callback);
+    node_shell_init(&fleet_shell_command_set);
+    
+    if (FLEET_FIRST_ROBOT_ID + FLEET_NUM_ROBOTS > MAX_ROBOTS) {
+        LOG_WARN("Robots %u-%u exceed MAX_ROBOTS (%u): build the BS with a larger MAX_ROBOTS\n",
+                 fleet_robot_id(0), fleet_robot_id(FLEET_NUM_ROBOTS - 1), MAX_ROBOTS);
+    }
+    
+    /* Wait until the base station (DAG root) is reachable */
+    etimer_set(&send_timer, CLOCK_SECOND);
+    while (!fleet.bs_reachable) {
+        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+        if (NETSTACK_ROUTING.node_is_reachable() &&
+            NETSTACK_ROUTING.get_root_ipaddr(&fleet.base_station_addr)) {
+            fleet.bs_reachable = 1;
+        } else {
+            etimer_reset(&send_timer);
+        }
+    }
+    
+    LOG_INFO("Robot fleet of %u virtual robots started, %u -> %u msg/s\n",
+             FLEET_NUM_ROBOTS, FLEET_RATE_START, FLEET_RATE_MAX);
+    LOG_INFO("FLEET_CURVE, step, offered_rate, reports, heartbeats, replies, unexpected, "
+             "timeouts, assign_per_s, p50_ms, p90_ms, p99_ms, max_ms\n");
+    
+    start_step();
+    etimer_set(&send_timer, FLEET_SEND_TICK);
+    
+    while(1) {
+        PROCESS_WAIT_EVENT();
+        
+        if (ev == PROCESS_EVENT_TIMER && data == &send_timer && !fleet.done) {
+            /* Spend accumulated credit, bounded per tick */
+            fleet.credit += (uint32_t)fleet.rate * FLEET_SEND_TICK;
+            for (uint8_t burst = 0; fleet.credit >= CLOCK_SECOND && burst < FLEET_MAX_BURST; burst++) {
+                send_next_message();
+                fleet.credit -= CLOCK_SECOND;
+            }
+            if (fleet.credit >= CLOCK_SECOND) {
+                fleet.credit = 0; // Generator itself saturated; drop the backlog
+            }
+            etimer_reset(&send_timer);
+            
+        } else if (ev == PROCESS_EVENT_TIMER && data == &step_timer) {
+            report_step();
+            if (fleet.rate >= FLEET_RATE_MAX) {
+                fleet.done = 1;
+                LOG_INFO("Robot fleet load sweep complete after %u steps\n", fleet.step + 1);
+            } else {
+                fleet.step++;
+                fleet.rate = (fleet.rate * 2 > FLEET_RATE_MAX) ? FLEET_RATE_MAX : fleet.rate * 2;
+                start_step();
+            }
+        }
+    }
+    
+    PROCESS_END();
+}
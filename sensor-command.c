@@ -0,0 +1,78 @@
+#include "sensor-command.h"
+#include <stddef.h>
+#include <string.h>
+
+#if SENSOR_CMD_MAX_ENTRIES > 255
+#error "Grid command entries are indexed by uint8_t"
+#endif
+
+#define SENSOR_CMD_HEADER_LEN offsetof(sensor_cmd_frame_t, entries)
+
+void sensor_cmd_init(sensor_cmd_frame_t *frame, uint8_t robot_id, uint8_t seqno,
+                     uint16_t x, uint16_t y) {
+    frame->magic[0] = SENSOR_CMD_MAGIC0;
+    frame->magic[1] = SENSOR_CMD_MAGIC1;
+    frame->robot_id = robot_id;
+    frame->seqno = seqno;
+    frame->x_coord = x;
+    frame->y_coord = y;
+    frame->num_entries = 0;
+}
+
+uint8_t sensor_cmd_add(sensor_cmd_frame_t *frame, uint8_t sensor_id, uint8_t action) {
+    if (frame->num_entries >= SENSOR_CMD_MAX_ENTRIES) {
+        return 0;
+    }
+    frame->entries[frame->num_entries].sensor_id = sensor_id;
+    frame->entries[frame->num_entries].action = action;
+    frame->num_entries++;
+    return 1;
+}
+
+uint16_t sensor_cmd_frame_len(const sensor_cmd_frame_t *frame) {
+    return SENSOR_CMD_HEADER_LEN + frame->num_entries * sizeof(sensor_cmd_entry_t);
+}
+
+uint8_t sensor_cmd_parse(const uint8_t *data, uint16_t datalen, sensor_cmd_frame_t *frame) {
+    if (datalen <= SENSOR_CMD_HEADER_LEN || datalen > sizeof(sensor_cmd_frame_t) ||
+        data[0] != SENSOR_CMD_MAGIC0 || data[1] != SENSOR_CMD_MAGIC1) {
+        return 0;
+    }
+    memcpy(frame, data, SENSOR_CMD_HEADER_LEN);
+    if (frame->num_entries > SENSOR_CMD_MAX_ENTRIES ||
+        datalen != sensor_cmd_frame_len(frame)) {
+        return 0;
+    }
+    memcpy(frame->entries, data + SENSOR_CMD_HEADER_LEN, datalen - SENSOR_CMD_HEADER_LEN);
+    return 1;
+}
+
+void sensor_cmd_ack_init(sensor_cmd_ack_t *ack, const sensor_cmd_frame_t *frame) {
+    ack->magic[0] = SENSOR_ACK_MAGIC0;
+    ack->magic[1] = SENSOR_ACK_MAGIC1;
+    ack->robot_id = frame->robot_id;
+    ack->seqno = frame->seqno;
+    memset(ack->applied, 0, sizeof(ack->applied));
+}
+
+uint8_t sensor_cmd_is_ack(const uint8_t *data, uint16_t datalen) {
+    return datalen == sizeof(sensor_cmd_ack_t) &&
+           data[0] == SENSOR_ACK_MAGIC0 && data[1] == SENSOR_ACK_MAGIC1;
+}
+
+uint8_t sensor_cmd_bit_get(const uint8_t *bitmap, uint8_t entry) {
+    return (bitmap[entry >> 3] >> (entry & 7)) & 1;
+}
+
+void sensor_cmd_bit_set(uint8_t *bitmap, uint8_t entry) {
+    bitmap[entry >> 3] |= (uint8_t)(1 << (entry & 7));
+}
+
+uint8_t sensor_cmd_unacked(const sensor_cmd_frame_t *frame, const uint8_t *acked) {
+    uint8_t missing = 0;
+    
+    for (uint8_t i = 0; i < frame->num_entries; i++) {
+        missing += !sensor_cmd_bit_get(acked, i);
+    }
+    return missing;
+}
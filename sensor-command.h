@@ -0,0 +1,75 @@
+#ifndef SENSOR_COMMAND_H_
+#define SENSOR_COMMAND_H_
+
+#include <stdint.h>
+#include "project-conf.h"
+
+/* Grid command frame, robot -> sensors: one broadcast per grid listing what
+   each addressed sensor has to do. Activate and relocate move the sensor to
+   the frame's grid centre and switch it to active; collect takes it into the
+   robot's stock, idle and silent until a later activate. A sensor (or a swarm
+   mote, for all its logical sensors) answers with one ack holding a bitmap of
+   the entries it applied. The robot ORs the acks together and rebroadcasts
+   the frame while entries are missing; a repeated seqno is only re-acked. */
+#define SENSOR_CMD_MAGIC0 'S'
+#define SENSOR_CMD_MAGIC1 'C'
+#define SENSOR_ACK_MAGIC0 'S'
+#define SENSOR_ACK_MAGIC1 'A'
+#define SENSOR_CMD_BITMAP_BYTES ((SENSOR_CMD_MAX_ENTRIES + 7) / 8)
+
+typedef enum {
+    SENSOR_CMD_COLLECT = 0,     // Into the robot's stock
+    SENSOR_CMD_ACTIVATE = 1,    // Out of the robot's stock, placed at the grid centre
+    SENSOR_CMD_RELOCATE = 2     // From the field to the grid centre
+} sensor_cmd_action_t;
+
+typedef struct {
+    uint8_t sensor_id;
+    uint8_t action;             // sensor_cmd_action_t
+} sensor_cmd_entry_t;
+
+typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t seqno;
+    uint16_t x_coord;           // Grid centre, for activate and relocate
+    uint16_t y_coord;
+    uint8_t num_entries;
+    sensor_cmd_entry_t entries[SENSOR_CMD_MAX_ENTRIES];
+} sensor_cmd_frame_t;
+
+typedef struct {
+    uint8_t magic[2];
+    uint8_t robot_id;
+    uint8_t seqno;
+    uint8_t applied[SENSOR_CMD_BITMAP_BYTES];   // Bit i: entry i applied
+} sensor_cmd_ack_t;
+
+/* Start an empty frame for the grid centred at (x, y) */
+void sensor_cmd_init(sensor_cmd_frame_t *frame, uint8_t robot_id, uint8_t seqno,
+                     uint16_t x, uint16_t y);
+
+/* Append an entry; 0 if the frame is full */
+uint8_t sensor_cmd_add(sensor_cmd_frame_t *frame, uint8_t sensor_id, uint8_t action);
+
+/* Bytes on air: only the used entries are sent */
+uint16_t sensor_cmd_frame_len(const sensor_cmd_frame_t *frame);
+
+/* Copy a received frame out of the (possibly unaligned) radio buffer;
+   0 if the datagram is not a well-formed frame */
+uint8_t sensor_cmd_parse(const uint8_t *data, uint16_t datalen, sensor_cmd_frame_t *frame);
+
+/* Start an empty ack for a received frame */
+void sensor_cmd_ack_init(sensor_cmd_ack_t *ack, const sensor_cmd_frame_t *frame);
+
+/* 1 if the datagram is an ack */
+uint8_t sensor_cmd_is_ack(const uint8_t *data, uint16_t datalen);
+
+/* Entry bitmaps, shared by acks and the robot's aggregate */
+uint8_t sensor_cmd_bit_get(const uint8_t *bitmap, uint8_t entry);
+void sensor_cmd_bit_set(uint8_t *bitmap, uint8_t entry);
+
+/* Entries of a frame not yet set in an aggregate bitmap */
+uint8_t sensor_cmd_unacked(const sensor_cmd_frame_t *frame, const uint8_t *acked);
+
+#endif /* SENSOR_COMMAND_H_ */
@@ -6,6 +6,12 @@
 #include "sys/clock.h"
 #include "random.h"
 #include "project-conf.h"
+#include "latency-histogram.h"
+#include "node-shell.h"
+#include "radio-trace.h"
+#include "log-queue.h"
+#include "energy-model.h"
+#include "sensor-command.h"
 #include "sys/log.h"
 #include <stdio.h>
 #include <string.h>
@@ -14,7 +20,7 @@
 /* Access to the Contiki node ID */
 extern unsigned short node_id;
 #define LOG_MODULE "SensorNode"
-#define LOG_LEVEL LOG_LEVEL_APP
+#define LOG_LEVEL app_log_level
 
 /* Sensor operational modes */
 typedef enum {
@@ -34,6 +40,16 @@ typedef struct {
     uint8_t sensor_status;
 } sensor_reply_msg_t;
 
+/* Sleep rotation for a sensor whose area awake sensors already k-cover */
+#define SLEEP_MSG_MAGIC0 'S'
+#define SLEEP_MSG_MAGIC1 'R'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t sensor_id;
+    uint8_t slot;         // Awake in this slot of the rotation
+    uint8_t num_slots;
+} sleep_schedule_msg_t;
+
 /* Sensor Node State */
 static struct {
     uint8_t sensor_id;
@@ -41,6 +57,7 @@ static struct {
     uint16_t y_position;
     sensor_mode_t current_mode;
     uint8_t is_deployed;  // 0 = randomly deployed, 1 = robot deployed
+    uint8_t is_collected; // In a robot's stock: idle and silent until activated
     
     /* Energy tracking */
     float total_energy_consumed;
@@ -55,19 +72,69 @@ static struct {
     uint32_t tx_operations;
     uint32_t rx_operations;
     uint32_t mode_switches;
+    uint32_t total_sensing_operations;    // Never reset, for conformance checks
+    uint32_t total_processing_operations;
+    uint32_t total_tx_operations;
+    uint32_t total_rx_operations;
     
     /* Timing */
     clock_time_t start_time;
     clock_time_t last_energy_calc;
     clock_time_t mode_start_time;
     clock_time_t last_sensing_time;
+    clock_time_t last_mp_time;        // Last Mp received, 0 once a command follows
     
     /* Communication */
     uip_ipaddr_t robot_addr;
     uint8_t robot_in_range;
+    
+    /* Sleep rotation commanded by a robot (sleep_slots = 0: none) */
+    uint8_t sleep_slot;
+    uint8_t sleep_slots;
+    clock_time_t sleep_start_time;
+    
+    /* Ack of the last grid command frame, resent if the robot repeats it */
+    sensor_cmd_ack_t last_ack;
+    uint8_t last_ack_valid;   // last_ack has entries for this sensor
 } sensor_node;
 
+/* Latency histograms */
+static latency_hist_t hist_mp_command;   // Mp received -> deploy/relocate command
+static latency_hist_t hist_mode_dwell;   // Time spent in a mode before switching
+static const latency_hist_t *const sensor_hists[] = { &hist_mp_command, &hist_mode_dwell };
+#define SENSOR_NUM_HISTS (sizeof(sensor_hists) / sizeof(sensor_hists[0]))
+static uint8_t latency_frame[LATENCY_FRAME_HEADER_LEN + SENSOR_NUM_HISTS * LATENCY_FRAME_ENTRY_LEN];
+
+/* Deferred log events posted from the radio callback path */
+enum {
+    SENSOR_LOG_MP_RECEIVED,
+    SENSOR_LOG_REPLY_SENT,
+    SENSOR_LOG_NEW_DEPLOYMENT,
+    SENSOR_LOG_RELOCATION,
+    SENSOR_LOG_COLLECTED,
+    SENSOR_LOG_COMMAND_ACKED,
+    SENSOR_LOG_POSITION_UPDATED,
+    SENSOR_LOG_MODE_IDLE,      // Followed by SENSOR_LOG_MODE_ACTIVE: indexed by sensor_mode_t
+    SENSOR_LOG_MODE_ACTIVE,
+    SENSOR_LOG_SLEEP_SCHEDULED,
+    SENSOR_LOG_NUM_EVENTS
+};
+
+static const log_event_desc_t sensor_log_events[SENSOR_LOG_NUM_EVENTS] = {
+    [SENSOR_LOG_MP_RECEIVED] = { "Received Mp from Robot %u - sending Sensor_M reply\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_REPLY_SENT] = { "Sent Sensor_M: (ID=%u, Pos=(%u,%u), Status=%u)\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_NEW_DEPLOYMENT] = { "New deployment from Robot stock: deploying to (%u, %u)\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_RELOCATION] = { "Robot relocation: moving from (%u, %u) to (%u, %u)\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_COLLECTED] = { "Collected into Robot %u stock - idle until redeployed\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_COMMAND_ACKED] = { "Acked grid command %u from Robot %u\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_POSITION_UPDATED] = { "Sensor relocated to (%u, %u) by robot\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_MODE_IDLE] = { "Switched to IDLE mode\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_MODE_ACTIVE] = { "Switched to ACTIVE mode\n", LOG_LEVEL_INFO },
+    [SENSOR_LOG_SLEEP_SCHEDULED] = { "Sleep rotation from robot: awake in slot %u of %u\n", LOG_LEVEL_INFO },
+};
+
 static struct simple_udp_connection udp_conn;
+static sensor_cmd_frame_t command_frame;
 static struct etimer sensing_timer;
 static struct etimer energy_timer;
 static struct etimer mode_timer;
@@ -75,64 +142,39 @@ static struct etimer mode_timer;
 PROCESS(sensor_node_process, "Sensor Node Process");
 AUTOSTART_PROCESSES(&sensor_node_process);
 
-/* Energy Calculation Functions */
-static float calculate_baseline_energy(float time_duration) {
-    return time_duration * P_BASELINE_SENSOR;
-}
-
-static float calculate_sensing_energy(uint32_t sensing_ops) {
-    // E_sensing = μ * r_i^2 (from LaTeX document)
-    float sensing_range_sq = SENSOR_PERCEPTION_RANGE * SENSOR_PERCEPTION_RANGE;
-    return sensing_ops * MU_SENSING * sensing_range_sq;
-}
-
-static float calculate_processing_energy(uint32_t processing_ops, float processing_time) {
-    return processing_ops * P_PROCESSING_SENSOR * processing_time;
-}
-
-static float calculate_radio_energy(uint32_t tx_ops, uint32_t rx_ops, float avg_tx_time, float avg_rx_time) {
-    float tx_energy = tx_ops * P_TRANSMIT_SENSOR * avg_tx_time;
-    float rx_energy = rx_ops * P_RECEIVE_SENSOR * avg_rx_time;
-    return tx_energy + rx_energy;
-}
-
+/* Energy Calculation (terms shared with energy-kernel.c via energy-model.h) */
 static void update_energy_consumption() {
     clock_time_t current_time = clock_time();
     float time_elapsed = (float)(current_time - sensor_node.last_energy_calc) / CLOCK_SECOND;
     
     /* Calculate baseline energy based on time in current mode */
-    sensor_node.baseline_energy += calculate_baseline_energy(time_elapsed);
+    sensor_node.baseline_energy += energy_sensor_baseline(time_elapsed);
     
     /* Calculate sensing energy */
-    sensor_node.sensing_energy += calculate_sensing_energy(sensor_node.sensing_operations);
+    sensor_node.sensing_energy += energy_sensor_sensing(sensor_node.sensing_operations);
     
     /* Calculate processing energy */
-    float avg_processing_time = 0.001; // 1ms average processing time
-    sensor_node.processing_energy += calculate_processing_energy(
-        sensor_node.processing_operations, avg_processing_time);
+    sensor_node.processing_energy += energy_sensor_processing(
+        sensor_node.processing_operations, ENERGY_AVG_OP_TIME);
     
     /* Calculate radio energy */
-    float avg_tx_time = 0.001; // 1ms average transmission time
-    float avg_rx_time = 0.001; // 1ms average reception time
-    sensor_node.radio_energy += calculate_radio_energy(
+    sensor_node.radio_energy += energy_sensor_radio(
         sensor_node.tx_operations, sensor_node.rx_operations,
-        avg_tx_time, avg_rx_time);
+        ENERGY_AVG_OP_TIME, ENERGY_AVG_OP_TIME);
     
-    /* Update total energy consumption */
-    if (sensor_node.current_mode == SENSOR_MODE_ACTIVE) {
-        sensor_node.total_energy_consumed = sensor_node.baseline_energy + 
-                                          sensor_node.sensing_energy +
-                                          sensor_node.processing_energy + 
-                                          sensor_node.radio_energy;
-    } else {
-        // Idle mode: baseline + radio energy only
-        sensor_node.total_energy_consumed = sensor_node.baseline_energy + 
-                                          sensor_node.radio_energy;
-    }
+    /* Update total energy consumption (idle mode: baseline + radio energy only) */
+    sensor_node.total_energy_consumed = energy_sensor_total(
+        sensor_node.current_mode == SENSOR_MODE_ACTIVE,
+        sensor_node.baseline_energy, sensor_node.sensing_energy,
+        sensor_node.processing_energy, sensor_node.radio_energy);
     
     sensor_node.last_energy_calc = current_time;
     
     /* Reset operation counters */
+    sensor_node.total_sensing_operations += sensor_node.sensing_operations;
+    sensor_node.total_processing_operations += sensor_node.processing_operations;
+    sensor_node.total_tx_operations += sensor_node.tx_operations;
+    sensor_node.total_rx_operations += sensor_node.rx_operations;
     sensor_node.sensing_operations = 0;
     sensor_node.processing_operations = 0;
     sensor_node.tx_operations = 0;
@@ -142,16 +184,23 @@ static void update_energy_consumption() {
 /* Sensor Operations */
 static void switch_to_mode(sensor_mode_t new_mode) {
     if (sensor_node.current_mode != new_mode) {
+        latency_hist_record(&hist_mode_dwell, clock_time() - sensor_node.mode_start_time);
         update_energy_consumption();
         sensor_node.current_mode = new_mode;
         sensor_node.mode_start_time = clock_time();
         sensor_node.mode_switches++;
         
-        LOG_INFO("Switched to %s mode\n", 
-                (new_mode == SENSOR_MODE_ACTIVE) ? "ACTIVE" : "IDLE");
+        log_queue_post(SENSOR_LOG_MODE_IDLE + new_mode, 0, 0, 0, 0);
     }
 }
 
+/* Mode for the current slot of a robot-commanded sleep rotation */
+static sensor_mode_t sleep_rotation_mode() {
+    clock_time_t slot = (clock_time() - sensor_node.sleep_start_time) / SLEEP_SLOT_DURATION;
+    return (slot % sensor_node.sleep_slots == sensor_node.sleep_slot) ?
+           SENSOR_MODE_ACTIVE : SENSOR_MODE_IDLE;
+}
+
 static void perform_sensing_operation() {
     if (sensor_node.current_mode == SENSOR_MODE_ACTIVE) {
         sensor_node.sensing_operations++;
@@ -179,7 +228,60 @@ static void update_sensor_position(uint16_t new_x, uint16_t new_y) {
     sensor_node.is_deployed = 1; // Robot deployed
     sensor_node.processing_operations++;
     
-    LOG_INFO("Sensor relocated to (%u, %u) by robot\n", new_x, new_y);
+    log_queue_post(SENSOR_LOG_POSITION_UPDATED, new_x, new_y, 0, 0);
+}
+
+/* Carry out one entry of a grid command frame addressed to this sensor */
+static void apply_grid_command(uint8_t robot_id, uint8_t action, uint16_t new_x, uint16_t new_y) {
+    if (sensor_node.last_mp_time != 0) {
+        latency_hist_record(&hist_mp_command, clock_time() - sensor_node.last_mp_time);
+        sensor_node.last_mp_time = 0;
+    }
+    
+    if (action == SENSOR_CMD_COLLECT) {
+        /* Into the robot's stock: no sensing, no sleep rotation, no Mp replies */
+        sensor_node.is_collected = 1;
+        sensor_node.sleep_slots = 0;
+        switch_to_mode(SENSOR_MODE_IDLE);
+        log_queue_post(SENSOR_LOG_COLLECTED, robot_id, 0, 0, 0);
+        return;
+    }
+    
+    if (action == SENSOR_CMD_ACTIVATE) {
+        log_queue_post(SENSOR_LOG_NEW_DEPLOYMENT, new_x, new_y, 0, 0);
+    } else {
+        log_queue_post(SENSOR_LOG_RELOCATION, sensor_node.x_position, sensor_node.y_position,
+                       new_x, new_y);
+    }
+    update_sensor_position(new_x, new_y);
+    sensor_node.is_collected = 0;
+    
+    /* Switch to active mode for a robot-placed sensor */
+    switch_to_mode(SENSOR_MODE_ACTIVE);
+}
+
+/* Grid command frame: apply the entries for this sensor once per seqno and
+   ack them; a rebroadcast only gets the ack again */
+static void handle_grid_command(const sensor_cmd_frame_t *command, const uip_ipaddr_t *sender_addr) {
+    if (command->robot_id != sensor_node.last_ack.robot_id ||
+        command->seqno != sensor_node.last_ack.seqno || sensor_node.last_ack.magic[0] == 0) {
+        sensor_cmd_ack_init(&sensor_node.last_ack, command);
+        sensor_node.last_ack_valid = 0;
+        for (uint8_t i = 0; i < command->num_entries; i++) {
+            if (command->entries[i].sensor_id == sensor_node.sensor_id) {
+                apply_grid_command(command->robot_id, command->entries[i].action,
+                                   command->x_coord, command->y_coord);
+                sensor_cmd_bit_set(sensor_node.last_ack.applied, i);
+                sensor_node.last_ack_valid = 1;
+            }
+        }
+    }
+    
+    if (sensor_node.last_ack_valid) {
+        simple_udp_sendto(&udp_conn, &sensor_node.last_ack, sizeof(sensor_node.last_ack), sender_addr);
+        sensor_node.tx_operations++;
+        log_queue_post(SENSOR_LOG_COMMAND_ACKED, command->seqno, command->robot_id, 0, 0);
+    }
 }
 
 /* Communication Handlers */
@@ -191,18 +293,49 @@ static void udp_rx_callback(struct simple_udp_connection *c,
                            const uint8_t *data,
                            uint16_t datalen) {
     
+    radio_trace_record(sender_addr, sender_port, receiver_addr, receiver_port, data, datalen);
     sensor_node.rx_operations++;
     sensor_node.processing_operations++;
     
-    /* Handle Mp message from robot */
-    if (datalen == sizeof(robot_discovery_msg_t)) {
+    if (latency_is_request(data, datalen)) {
+        uint16_t frame_len = latency_frame_build(LATENCY_NODE_SENSOR, sensor_hists, SENSOR_NUM_HISTS,
+                                                 latency_frame, sizeof(latency_frame));
+        simple_udp_sendto(&udp_conn, latency_frame, frame_len, sender_addr);
+        sensor_node.tx_operations++;
+        return;
+    }
+    
+    /* Grid command frame from a robot */
+    if (sensor_cmd_parse(data, datalen, &command_frame)) {
+        handle_grid_command(&command_frame, sender_addr);
+        return;
+    }
+    
+    /* Sleep rotation: applied from the next mode_timer tick */
+    if (datalen == sizeof(sleep_schedule_msg_t) &&
+        data[0] == SLEEP_MSG_MAGIC0 && data[1] == SLEEP_MSG_MAGIC1) {
+        const sleep_schedule_msg_t *sleep_msg = (const sleep_schedule_msg_t *)data;
+        
+        if (sleep_msg->sensor_id == sensor_node.sensor_id && !sensor_node.is_deployed &&
+            !sensor_node.is_collected && sleep_msg->slot < sleep_msg->num_slots) {
+            sensor_node.sleep_slot = sleep_msg->slot;
+            sensor_node.sleep_slots = sleep_msg->num_slots;
+            sensor_node.sleep_start_time = clock_time();
+            log_queue_post(SENSOR_LOG_SLEEP_SCHEDULED, sleep_msg->slot + 1, sleep_msg->num_slots, 0, 0);
+        }
+        return;
+    }
+    
+    /* Handle Mp message from robot; a sensor in a robot's stock is not in the field */
+    if (datalen == sizeof(robot_discovery_msg_t) && !sensor_node.is_collected) {
         robot_discovery_msg_t *robot_msg = (robot_discovery_msg_t *)data;
         
-        LOG_INFO("Received Mp from Robot %u - sending Sensor_M reply\n", robot_msg->robot_id);
+        log_queue_post(SENSOR_LOG_MP_RECEIVED, robot_msg->robot_id, 0, 0, 0);
         
         /* Store robot address for future communication */
         uip_ipaddr_copy(&sensor_node.robot_addr, sender_addr);
         sensor_node.robot_in_range = 1;
+        sensor_node.last_mp_time = clock_time();
         
         /* Send Sensor_M reply as per APP_I specification */
         sensor_reply_msg_t reply;
@@ -214,69 +347,8 @@ static void udp_rx_callback(struct simple_udp_connection *c,
         simple_udp_sendto(&udp_conn, &reply, sizeof(reply), sender_addr);
         sensor_node.tx_operations++;
         
-        LOG_INFO("Sent Sensor_M: (ID=%u, Pos=(%u,%u), Status=%u)\n", 
-                reply.sensor_id, reply.x_coord, reply.y_coord, reply.sensor_status);
-    }
-    
-    /* Handle robot deployment or relocation command during dispersion phase */
-    if (datalen == sizeof(uint16_t) * 3) {
-        uint16_t *command = (uint16_t*)data;
-        uint16_t new_x = command[0];
-        uint16_t new_y = command[1];
-        uint16_t is_new_deployment = command[2];
-        
-        if (is_new_deployment) {
-            /* This is a request to deploy a new sensor from robot stock 
-               For simplicity, any idle sensor that hasn't been redeployed yet can respond */
-            if (!sensor_node.is_deployed) {
-                LOG_INFO("New deployment from Robot stock: deploying to (%u, %u)\n", new_x, new_y);
-                update_sensor_position(new_x, new_y);
-                sensor_node.is_deployed = 1;  // Mark as deployed by robot
-                
-                /* Switch to active mode for deployed sensor */
-                switch_to_mode(SENSOR_MODE_ACTIVE);
-                
-                /* Send confirmation */
-                sensor_reply_msg_t confirm;
-                confirm.sensor_id = sensor_node.sensor_id;
-                confirm.x_coord = sensor_node.x_position;
-                confirm.y_coord = sensor_node.y_position;
-                confirm.sensor_status = 1; // Active
-                
-                simple_udp_sendto(&udp_conn, &confirm, sizeof(confirm), sender_addr);
-                sensor_node.tx_operations++;
-                
-                LOG_INFO("Confirmed deployment - now active at (%u, %u)\n", new_x, new_y);
-            }
-        }
-        else {
-            /* This is a relocation request for randomly deployed sensors
-               Check if distance is within range to ensure we're one of the targeted sensors */
-            float distance = sqrt(pow((float)(new_x - sensor_node.x_position), 2) + 
-                                 pow((float)(new_y - sensor_node.y_position), 2));
-            
-            if (distance <= SENSOR_PERCEPTION_RANGE * 2) { 
-                LOG_INFO("Robot relocation: moving from (%u, %u) to (%u, %u)\n", 
-                        sensor_node.x_position, sensor_node.y_position, new_x, new_y);
-                update_sensor_position(new_x, new_y);
-                sensor_node.is_deployed = 1; // Mark as relocated by robot
-                
-                /* Switch to active mode after robot relocation */
-                switch_to_mode(SENSOR_MODE_ACTIVE);
-                
-                /* Send confirmation */
-                sensor_reply_msg_t confirm;
-                confirm.sensor_id = sensor_node.sensor_id;
-                confirm.x_coord = sensor_node.x_position;
-                confirm.y_coord = sensor_node.y_position;
-                confirm.sensor_status = 1; // Active after robot deployment
-                
-                simple_udp_sendto(&udp_conn, &confirm, sizeof(confirm), sender_addr);
-                sensor_node.tx_operations++;
-                
-                LOG_INFO("Confirmed relocation - now active at grid center\n");
-            }
-        }
+        log_queue_post(SENSOR_LOG_REPLY_SENT, reply.sensor_id, reply.x_coord,
+                       reply.y_coord, reply.sensor_status);
     }
 }
 
@@ -306,6 +378,13 @@ static void print_energy_report() {
     LOG_INFO("Position: (%u, %u)\n", sensor_node.x_position, sensor_node.y_position);
     LOG_INFO("Mode: %s\n", (sensor_node.current_mode == SENSOR_MODE_ACTIVE) ? "ACTIVE" : "IDLE");
     LOG_INFO("Deployed by: %s\n", sensor_node.is_deployed ? "Robot" : "Random");
+    if (sensor_node.is_collected) {
+        LOG_INFO("Collected: in robot stock\n");
+    }
+    if (sensor_node.sleep_slots > 0 && !sensor_node.is_deployed) {
+        LOG_INFO("Sleep rotation: awake in slot %u of %u\n",
+                 sensor_node.sleep_slot + 1, sensor_node.sleep_slots);
+    }
     LOG_INFO("Elapsed time: %.2f seconds\n", elapsed_seconds);
     LOG_INFO("Baseline energy: %.6f J\n", sensor_node.baseline_energy);
     
@@ -319,9 +398,70 @@ static void print_energy_report() {
     LOG_INFO("Operations - Sensing: %u, Processing: %u, TX: %u, RX: %u\n",
             sensor_node.sensing_operations, sensor_node.processing_operations,
             sensor_node.tx_operations, sensor_node.rx_operations);
+    LOG_INFO("PAPER_SENSOR, %u, %u, %.3f, %lu, %lu, %lu, %lu, %.9f, %.9f, %.9f, %.9f, %.9f\n",
+             sensor_node.sensor_id, sensor_node.current_mode, elapsed_seconds,
+             (unsigned long)sensor_node.total_sensing_operations,
+             (unsigned long)sensor_node.total_processing_operations,
+             (unsigned long)sensor_node.total_tx_operations,
+             (unsigned long)sensor_node.total_rx_operations,
+             sensor_node.baseline_energy, sensor_node.sensing_energy, sensor_node.processing_energy,
+             sensor_node.radio_energy, sensor_node.total_energy_consumed);
+    for (uint8_t i = 0; i < SENSOR_NUM_HISTS; i++) {
+        latency_hist_log(sensor_hists[i]);
+    }
+    log_queue_log_stats();
     LOG_INFO("============================\n");
 }
 
+/* Shell Commands (live inspection over the serial console) */
+#if NODE_SHELL_ENABLED
+static PT_THREAD(cmd_energy(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    update_energy_consumption();
+    SHELL_OUTPUT(output, "Sensor %u at (%u, %u), mode %s, deployed by %s\n", sensor_node.sensor_id,
+                 sensor_node.x_position, sensor_node.y_position,
+                 (sensor_node.current_mode == SENSOR_MODE_ACTIVE) ? "ACTIVE" : "IDLE",
+                 sensor_node.is_deployed ? "Robot" : "Random");
+    SHELL_OUTPUT(output, "Baseline energy: %.6f J\n", sensor_node.baseline_energy);
+    SHELL_OUTPUT(output, "Sensing energy: %.6f J\n", sensor_node.sensing_energy);
+    SHELL_OUTPUT(output, "Processing energy: %.6f J\n", sensor_node.processing_energy);
+    SHELL_OUTPUT(output, "Radio energy: %.6f J\n", sensor_node.radio_energy);
+    SHELL_OUTPUT(output, "Total energy: %.6f J\n", sensor_node.total_energy_consumed);
+    
+    PT_END(pt);
+}
+
+static PT_THREAD(cmd_profile(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    SHELL_OUTPUT(output, "Operations - Sensing: %lu, Processing: %lu, TX: %lu, RX: %lu, Mode switches: %lu\n",
+                 (unsigned long)sensor_node.sensing_operations,
+                 (unsigned long)sensor_node.processing_operations,
+                 (unsigned long)sensor_node.tx_operations, (unsigned long)sensor_node.rx_operations,
+                 (unsigned long)sensor_node.mode_switches);
+    
+    PT_END(pt);
+}
+
+static const struct shell_command_t sensor_shell_commands[] = {
+    { "energy", cmd_energy, "'> energy': Show mode, position and energy counters" },
+    { "profile", cmd_profile, "'> profile': Show operation counters" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t sensor_shell_command_set = {
+    .next = NULL,
+    .commands = sensor_shell_commands,
+};
+#endif /* NODE_SHELL_ENABLED */
+
+#if RADIO_REPLAY_ENABLED
+static void replay_done() {
+    print_energy_report();
+}
+#endif /* RADIO_REPLAY_ENABLED */
+
 PROCESS_THREAD(sensor_node_process, ev, data) {
     PROCESS_BEGIN();
     
@@ -337,12 +477,19 @@ PROCESS_THREAD(sensor_node_process, ev, data) {
     sensor_node.current_mode = SENSOR_MODE_IDLE;
     sensor_node.robot_in_range = 0;
     memset(&sensor_node.robot_addr, 0, sizeof(sensor_node.robot_addr));
+    log_queue_init("SensorNode", sensor_log_events, SENSOR_LOG_NUM_EVENTS);
+    latency_hist_init(&hist_mp_command, "Mp->command");
+    latency_hist_init(&hist_mode_dwell, "mode dwell");
     
     /* Initialize position */
     initialize_sensor_position();
     
     /* Initialize UDP connection */
     simple_udp_register(&udp_conn, UDP_CLIENT_PORT, NULL, UDP_SERVER_PORT, udp_rx_callback);
+    radio_replay_start(&udp_conn, udp_rx_callback, replay_done);
+    
+    /* Register inspection commands on the serial shell */
+    node_shell_init(&sensor_shell_command_set);
     
     /* Set timers */
     etimer_set(&sensing_timer, MESSAGE_SEND_INTERVAL);
@@ -369,8 +516,13 @@ PROCESS_THREAD(sensor_node_process, ev, data) {
                 
             } else if (data == &mode_timer) {
                 /* Randomly switch between active and idle modes if not deployed by robot */
-                if (!sensor_node.is_deployed) {
-                    if (random_rand() % 100 < 30) { // 30% chance to switch mode
+                if (sensor_node.is_collected) {
+                    /* In a robot's stock: stays idle until activated */
+                } else if (!sensor_node.is_deployed) {
+                    if (sensor_node.sleep_slots > 0) {
+                        /* Redundant sensor: follow the robot's sleep rotation */
+                        switch_to_mode(sleep_rotation_mode());
+                    } else if (random_rand() % 100 < 30) { // 30% chance to switch mode
                         sensor_mode_t new_mode = (sensor_node.current_mode == SENSOR_MODE_ACTIVE) ? 
                                                SENSOR_MODE_IDLE : SENSOR_MODE_ACTIVE;
                         switch_to_mode(new_mode);
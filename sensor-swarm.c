@@ -0,0 +1,494 @@
+#include "contiki.h"
+#include "net/routing/routing.h"
+#include "net/netstack.h"
+#include "net/ipv6/simple-udp.h"
+#include "sys/etimer.h"
+#include "sys/clock.h"
+#include "random.h"
+#include "project-conf.h"
+#include "node-shell.h"
+#include "log-queue.h"
+#include "energy-model.h"
+#include "sensor-command.h"
+#include "sys/log.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/* Access to the Contiki node ID */
+extern unsigned short node_id;
+#define LOG_MODULE "SensorSwarm"
+#define LOG_LEVEL app_log_level
+
+#if SWARM_ID_BASE + SWARM_MAX_MOTES * SWARM_NUM_SENSORS > 256
+#error "Swarm logical sensor IDs must fit in uint8_t"
+#endif
+
+/* One mote emulating SWARM_NUM_SENSORS logical sensors. Each logical sensor
+   follows sensor-node.c: it answers Mp with Sensor_M, obeys grid commands
+   and keeps its own mode and energy state. The mote acks a grid command once
+   for all of its logical sensors. Replies are spread over
+   SWARM_REPLY_DELAY + [0, SWARM_REPLY_JITTER] so a swarm produces a reply
+   storm shaped like that many real motes. */
+
+/* Sensor operational modes */
+typedef enum {
+    SENSOR_MODE_IDLE = 0,
+    SENSOR_MODE_ACTIVE = 1
+} sensor_mode_t;
+
+/* Message structures (same wire format as sensor-node.c) */
+typedef struct {
+    uint8_t robot_id;
+} robot_discovery_msg_t;
+
+typedef struct {
+    uint8_t sensor_id;
+    uint16_t x_coord;
+    uint16_t y_coord;
+    uint8_t sensor_status;
+} sensor_reply_msg_t;
+
+#define SLEEP_MSG_MAGIC0 'S'
+#define SLEEP_MSG_MAGIC1 'R'
+typedef struct {
+    uint8_t magic[2];
+    uint8_t sensor_id;
+    uint8_t slot;           // Awake in this slot of the rotation
+    uint8_t num_slots;
+} sleep_schedule_msg_t;
+
+/* Logical sensor state */
+typedef struct {
+    uint8_t sensor_id;
+    uint16_t x_position;
+    uint16_t y_position;
+    uint8_t current_mode;   // sensor_mode_t
+    uint8_t is_deployed;    // 0 = randomly deployed, 1 = robot deployed
+    uint8_t is_collected;   // In a robot's stock: idle and silent until activated
+    uint8_t reply_pending;  // Sensor_M, confirmation or status update queued
+    clock_time_t reply_due;
+    
+    /* Sleep rotation commanded by a robot (sleep_slots = 0: none) */
+    uint8_t sleep_slot;
+    uint8_t sleep_slots;
+    clock_time_t sleep_start_time;
+    
+    /* Energy tracking */
+    float baseline_energy;
+    float sensing_energy;
+    float processing_energy;
+    float radio_energy;
+    float total_energy_consumed;
+    
+    /* Operation counters for energy calculation */
+    uint16_t sensing_operations;
+    uint16_t processing_operations;
+    uint16_t tx_operations;
+    uint16_t rx_operations;
+} swarm_sensor_t;
+
+/* Sensor Swarm State */
+static struct {
+    swarm_sensor_t sensors[SWARM_NUM_SENSORS];
+    uint8_t id_base;
+    
+    /* Swarm-wide counters */
+    uint32_t mp_received;
+    uint32_t commands_received;
+    uint32_t replies_sent;
+    
+    /* Timing */
+    clock_time_t start_time;
+    clock_time_t last_energy_calc;
+    
+    /* Communication */
+    uip_ipaddr_t robot_addr;
+    uint8_t robot_in_range;
+    
+    /* Aggregate ack of the last grid command frame, resent if the robot repeats it */
+    sensor_cmd_ack_t last_ack;
+    uint8_t last_ack_valid;   // last_ack has entries for this mote
+} swarm;
+
+/* Deferred log events posted from the radio callback path */
+enum {
+    SWARM_LOG_MP_RECEIVED,
+    SWARM_LOG_DEPLOYED,
+    SWARM_LOG_RELOCATED,
+    SWARM_LOG_COLLECTED,
+    SWARM_LOG_NUM_EVENTS
+};
+
+static const log_event_desc_t swarm_log_events[SWARM_LOG_NUM_EVENTS] = {
+    [SWARM_LOG_MP_RECEIVED] = { "Received Mp from Robot %u - %u logical sensors replying\n", LOG_LEVEL_INFO },
+    [SWARM_LOG_DEPLOYED] = { "Deployed %u logical sensors from Robot stock to (%u, %u)\n", LOG_LEVEL_INFO },
+    [SWARM_LOG_RELOCATED] = { "Relocated %u logical sensors to (%u, %u)\n", LOG_LEVEL_INFO },
+    [SWARM_LOG_COLLECTED] = { "Robot %u collected %u logical sensors into stock\n", LOG_LEVEL_INFO },
+};
+
+static struct simple_udp_connection udp_conn;
+static sensor_cmd_frame_t command_frame;
+static struct etimer reply_timer;
+static struct etimer sensing_timer;
+static struct etimer energy_timer;
+static struct etimer mode_timer;
+
+PROCESS(sensor_swarm_process, "Sensor Swarm Process");
+AUTOSTART_PROCESSES(&sensor_swarm_process);
+
+/* Energy Calculation (per logical sensor, terms shared via energy-model.h) */
+static void update_energy_consumption() {
+    clock_time_t current_time = clock_time();
+    float time_elapsed = (float)(current_time - swarm.last_energy_calc) / CLOCK_SECOND;
+    
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        swarm_sensor_t *sensor = &swarm.sensors[i];
+        
+        sensor->baseline_energy += energy_sensor_baseline(time_elapsed);
+        sensor->sensing_energy += energy_sensor_sensing(sensor->sensing_operations);
+        sensor->processing_energy += energy_sensor_processing(sensor->processing_operations,
+                                                              ENERGY_AVG_OP_TIME);
+        sensor->radio_energy += energy_sensor_radio(sensor->tx_operations, sensor->rx_operations,
+                                                    ENERGY_AVG_OP_TIME, ENERGY_AVG_OP_TIME);
+        sensor->total_energy_consumed = energy_sensor_total(
+            sensor->current_mode == SENSOR_MODE_ACTIVE, sensor->baseline_energy,
+            sensor->sensing_energy, sensor->processing_energy, sensor->radio_energy);
+        
+        sensor->sensing_operations = 0;
+        sensor->processing_operations = 0;
+        sensor->tx_operations = 0;
+        sensor->rx_operations = 0;
+    }
+    
+    swarm.last_energy_calc = current_time;
+}
+
+/* Reply Scheduling */
+static void schedule_reply(swarm_sensor_t *sensor) {
+    sensor->reply_pending = 1;
+    sensor->reply_due = clock_time() + SWARM_REPLY_DELAY +
+                        (SWARM_REPLY_JITTER > 0 ? random_rand() % (SWARM_REPLY_JITTER + 1) : 0);
+}
+
+/* Arm the reply timer for the earliest pending reply (also called from the
+   UDP callback, so bind the etimer to the swarm process explicitly) */
+static void arm_reply_timer() {
+    clock_time_t now = clock_time();
+    clock_time_t next_due = 0;
+    uint8_t pending = 0;
+    
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        if (swarm.sensors[i].reply_pending &&
+            (!pending || CLOCK_LT(swarm.sensors[i].reply_due, next_due))) {
+            next_due = swarm.sensors[i].reply_due;
+            pending = 1;
+        }
+    }
+    
+    if (pending) {
+        PROCESS_CONTEXT_BEGIN(&sensor_swarm_process);
+        etimer_set(&reply_timer, CLOCK_LT(now, next_due) ? next_due - now : 1);
+        PROCESS_CONTEXT_END(&sensor_swarm_process);
+    }
+}
+
+static void send_due_replies() {
+    clock_time_t now = clock_time();
+    
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        swarm_sensor_t *sensor = &swarm.sensors[i];
+        if (!sensor->reply_pending || CLOCK_LT(now, sensor->reply_due)) {
+            continue;
+        }
+        
+        sensor_reply_msg_t reply;
+        reply.sensor_id = sensor->sensor_id;
+        reply.x_coord = sensor->x_position;
+        reply.y_coord = sensor->y_position;
+        reply.sensor_status = (sensor->current_mode == SENSOR_MODE_ACTIVE) ? 1 : 0;
+        
+        simple_udp_sendto(&udp_conn, &reply, sizeof(reply), &swarm.robot_addr);
+        sensor->tx_operations++;
+        sensor->reply_pending = 0;
+        swarm.replies_sent++;
+    }
+    
+    arm_reply_timer();
+}
+
+static void switch_to_mode(swarm_sensor_t *sensor, sensor_mode_t new_mode) {
+    if (sensor->current_mode != new_mode) {
+        sensor->current_mode = new_mode;
+        sensor->processing_operations++;
+    }
+}
+
+static sensor_mode_t sleep_rotation_mode(const swarm_sensor_t *sensor) {
+    clock_time_t slot = (clock_time() - sensor->sleep_start_time) / SLEEP_SLOT_DURATION;
+    return (slot % sensor->sleep_slots == sensor->sleep_slot) ? SENSOR_MODE_ACTIVE : SENSOR_MODE_IDLE;
+}
+
+static void move_sensor(swarm_sensor_t *sensor, uint16_t new_x, uint16_t new_y) {
+    sensor->x_position = new_x;
+    sensor->y_position = new_y;
+    sensor->is_deployed = 1; // Robot deployed
+    sensor->is_collected = 0;
+    sensor->processing_operations++;
+    switch_to_mode(sensor, SENSOR_MODE_ACTIVE);
+}
+
+/* Grid command frame: apply the entries for this mote's logical sensors once
+   per seqno and ack them all in one bitmap; a rebroadcast only gets the ack */
+static void handle_grid_command(const sensor_cmd_frame_t *command, const uip_ipaddr_t *sender_addr) {
+    uint8_t counts[3] = { 0, 0, 0 }; // Indexed by sensor_cmd_action_t
+    swarm_sensor_t *acking = NULL;   // Charged with the aggregate ack
+    
+    uip_ipaddr_copy(&swarm.robot_addr, sender_addr);
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        swarm.sensors[i].rx_operations++;
+        swarm.sensors[i].processing_operations++;
+    }
+    
+    if (command->robot_id != swarm.last_ack.robot_id || command->seqno != swarm.last_ack.seqno ||
+        swarm.last_ack.magic[0] == 0) {
+        swarm.commands_received++;
+        sensor_cmd_ack_init(&swarm.last_ack, command);
+        swarm.last_ack_valid = 0;
+        
+        for (uint8_t i = 0; i < command->num_entries; i++) {
+            const sensor_cmd_entry_t *entry = &command->entries[i];
+            if (entry->sensor_id < swarm.id_base || entry->sensor_id >= swarm.id_base + SWARM_NUM_SENSORS ||
+                entry->action > SENSOR_CMD_RELOCATE) {
+                continue;
+            }
+            swarm_sensor_t *sensor = &swarm.sensors[entry->sensor_id - swarm.id_base];
+            
+            if (entry->action == SENSOR_CMD_COLLECT) {
+                sensor->is_collected = 1;
+                sensor->sleep_slots = 0;
+                switch_to_mode(sensor, SENSOR_MODE_IDLE);
+            } else {
+                move_sensor(sensor, command->x_coord, command->y_coord);
+            }
+            counts[entry->action]++;
+            sensor_cmd_bit_set(swarm.last_ack.applied, i);
+            swarm.last_ack_valid = 1;
+        }
+        
+        if (counts[SENSOR_CMD_ACTIVATE] > 0) {
+            log_queue_post(SWARM_LOG_DEPLOYED, counts[SENSOR_CMD_ACTIVATE], command->x_coord,
+                           command->y_coord, 0);
+        }
+        if (counts[SENSOR_CMD_RELOCATE] > 0) {
+            log_queue_post(SWARM_LOG_RELOCATED, counts[SENSOR_CMD_RELOCATE], command->x_coord,
+                           command->y_coord, 0);
+        }
+        if (counts[SENSOR_CMD_COLLECT] > 0) {
+            log_queue_post(SWARM_LOG_COLLECTED, command->robot_id, counts[SENSOR_CMD_COLLECT], 0, 0);
+        }
+    }
+    
+    if (swarm.last_ack_valid) {
+        for (uint8_t i = 0; i < command->num_entries && acking == NULL; i++) {
+            if (sensor_cmd_bit_get(swarm.last_ack.applied, i)) {
+                acking = &swarm.sensors[command->entries[i].sensor_id - swarm.id_base];
+            }
+        }
+        simple_udp_sendto(&udp_conn, &swarm.last_ack, sizeof(swarm.last_ack), sender_addr);
+        acking->tx_operations++;
+    }
+}
+
+/* Communication Handlers */
+static void udp_rx_callback(struct simple_udp_connection *c,
+                           const uip_ipaddr_t *sender_addr,
+                           uint16_t sender_port,
+                           const uip_ipaddr_t *receiver_addr,
+                           uint16_t receiver_port,
+                           const uint8_t *data,
+                           uint16_t datalen) {
+    
+    /* Grid command frame from a robot */
+    if (sensor_cmd_parse(data, datalen, &command_frame)) {
+        handle_grid_command(&command_frame, sender_addr);
+        return;
+    }
+    
+    /* Sleep rotation for one redundant logical sensor */
+    if (datalen == sizeof(sleep_schedule_msg_t) &&
+        data[0] == SLEEP_MSG_MAGIC0 && data[1] == SLEEP_MSG_MAGIC1) {
+        const sleep_schedule_msg_t *sleep_msg = (const sleep_schedule_msg_t *)data;
+        
+        for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+            swarm_sensor_t *sensor = &swarm.sensors[i];
+            sensor->rx_operations++;
+            sensor->processing_operations++;
+            if (sensor->sensor_id == sleep_msg->sensor_id && !sensor->is_deployed &&
+                !sensor->is_collected && sleep_msg->slot < sleep_msg->num_slots) {
+                sensor->sleep_slot = sleep_msg->slot;
+                sensor->sleep_slots = sleep_msg->num_slots;
+                sensor->sleep_start_time = clock_time();
+            }
+        }
+        return;
+    }
+    
+    /* Handle Mp message from robot: every logical sensor in the field answers */
+    if (datalen == sizeof(robot_discovery_msg_t)) {
+        robot_discovery_msg_t *robot_msg = (robot_discovery_msg_t *)data;
+        
+        uip_ipaddr_copy(&swarm.robot_addr, sender_addr);
+        swarm.robot_in_range = 1;
+        swarm.mp_received++;
+        
+        for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+            swarm.sensors[i].rx_operations++;
+            swarm.sensors[i].processing_operations++;
+            if (!swarm.sensors[i].is_collected) {
+                schedule_reply(&swarm.sensors[i]);
+            }
+        }
+        log_queue_post(SWARM_LOG_MP_RECEIVED, robot_msg->robot_id, SWARM_NUM_SENSORS, 0, 0);
+        arm_reply_timer();
+    }
+}
+
+static void print_energy_report() {
+    update_energy_consumption();
+    
+    clock_time_t elapsed = clock_time() - swarm.start_time;
+    float elapsed_seconds = (float)elapsed / CLOCK_SECOND;
+    float total_energy = 0;
+    uint8_t active = 0;
+    uint8_t deployed = 0;
+    uint8_t collected = 0;
+    
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        total_energy += swarm.sensors[i].total_energy_consumed;
+        active += swarm.sensors[i].current_mode == SENSOR_MODE_ACTIVE;
+        deployed += swarm.sensors[i].is_deployed;
+        collected += swarm.sensors[i].is_collected;
+    }
+    
+    LOG_INFO("=== SENSOR SWARM ENERGY REPORT ===\n");
+    LOG_INFO("Logical sensors: %u (IDs %u-%u), %u active, %u robot deployed, %u in robot stock\n",
+             SWARM_NUM_SENSORS, swarm.id_base, swarm.id_base + SWARM_NUM_SENSORS - 1, active, deployed,
+             collected);
+    LOG_INFO("Elapsed time: %.2f seconds\n", elapsed_seconds);
+    LOG_INFO("Mp received: %lu, commands: %lu, replies sent: %lu\n",
+             (unsigned long)swarm.mp_received, (unsigned long)swarm.commands_received,
+             (unsigned long)swarm.replies_sent);
+    LOG_INFO("Total energy (all logical sensors): %.6f J, mean %.6f J\n",
+             total_energy, total_energy / SWARM_NUM_SENSORS);
+    log_queue_log_stats();
+    LOG_INFO("==================================\n");
+}
+
+/* Shell Commands (live inspection over the serial console) */
+#if NODE_SHELL_ENABLED
+static PT_THREAD(cmd_swarm(struct pt *pt, shell_output_func output, char *args)) {
+    PT_BEGIN(pt);
+    
+    update_energy_consumption();
+    SHELL_OUTPUT(output, "sensor_id, x, y, mode, deployed, pending, energy_j\n");
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        const swarm_sensor_t *sensor = &swarm.sensors[i];
+        SHELL_OUTPUT(output, "%u, %u, %u, %u, %u, %u, %.6f\n", sensor->sensor_id,
+                     sensor->x_position, sensor->y_position, sensor->current_mode,
+                     sensor->is_deployed, sensor->reply_pending, sensor->total_energy_consumed);
+    }
+    
+    PT_END(pt);
+}
+
+static const struct shell_command_t swarm_shell_commands[] = {
+    { "swarm", cmd_swarm, "'> swarm': Dump every logical sensor of this mote" },
+    { NULL, NULL, NULL },
+};
+
+static struct shell_command_set_t swarm_shell_command_set = {
+    .next = NULL,
+    .commands = swarm_shell_commands,
+};
+#endif /* NODE_SHELL_ENABLED */
+
+PROCESS_THREAD(sensor_swarm_process, ev, data) {
+    PROCESS_BEGIN();
+    
+    /* Logical sensor IDs: one block of SWARM_NUM_SENSORS per swarm mote */
+    memset(&swarm, 0, sizeof(swarm));
+    swarm.id_base = SWARM_ID_BASE + (node_id % SWARM_MAX_MOTES) * SWARM_NUM_SENSORS;
+    swarm.start_time = clock_time();
+    swarm.last_energy_calc = swarm.start_time;
+    log_queue_init("SensorSwarm", swarm_log_events, SWARM_LOG_NUM_EVENTS);
+    
+    /* According to APP_I, sensors are initially randomly deployed in the target area */
+    for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+        swarm.sensors[i].sensor_id = swarm.id_base + i;
+        swarm.sensors[i].x_position = random_rand() % TARGET_AREA_WIDTH;
+        swarm.sensors[i].y_position = random_rand() % TARGET_AREA_HEIGHT;
+        swarm.sensors[i].current_mode = SENSOR_MODE_IDLE;
+    }
+    
+    /* Initialize UDP connection */
+    simple_udp_register(&udp_conn, UDP_CLIENT_PORT, NULL, UDP_SERVER_PORT, udp_rx_callback);
+    
+    /* Register inspection commands on the serial shell */
+    node_shell_init(&swarm_shell_command_set);
+    
+    /* Set timers */
+    etimer_set(&sensing_timer, MESSAGE_SEND_INTERVAL);
+    etimer_set(&energy_timer, ENERGY_REPORT_INTERVAL);
+    etimer_set(&mode_timer, 10 * CLOCK_SECOND);
+    
+    LOG_INFO("Sensor Swarm initialized: %u logical sensors, IDs %u-%u\n",
+             SWARM_NUM_SENSORS, swarm.id_base, swarm.id_base + SWARM_NUM_SENSORS - 1);
+    
+    while(1) {
+        PROCESS_WAIT_EVENT();
+        
+        if (ev == PROCESS_EVENT_TIMER) {
+            if (data == &reply_timer) {
+                send_due_replies();
+                
+            } else if (data == &sensing_timer) {
+                /* Active sensors sense and, once a robot is known, send a status update */
+                for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+                    if (swarm.sensors[i].current_mode == SENSOR_MODE_ACTIVE) {
+                        swarm.sensors[i].sensing_operations++;
+                        swarm.sensors[i].processing_operations++;
+                        if (swarm.robot_in_range) {
+                            schedule_reply(&swarm.sensors[i]);
+                        }
+                    }
+                }
+                arm_reply_timer();
+                etimer_reset(&sensing_timer);
+                
+            } else if (data == &energy_timer) {
+                print_energy_report();
+                etimer_reset(&energy_timer);
+                
+            } else if (data == &mode_timer) {
+                /* Randomly switch modes of sensors not deployed by a robot,
+                   unless a robot put them on a sleep rotation */
+                for (uint8_t i = 0; i < SWARM_NUM_SENSORS; i++) {
+                    swarm_sensor_t *sensor = &swarm.sensors[i];
+                    if (sensor->is_collected) {
+                        continue; // In a robot's stock: stays idle until activated
+                    }
+                    if (!sensor->is_deployed && sensor->sleep_slots > 0) {
+                        switch_to_mode(sensor, sleep_rotation_mode(sensor));
+                    } else if (!sensor->is_deployed && random_rand() % 100 < 30) { // 30% chance to switch mode
+                        switch_to_mode(sensor, sensor->current_mode == SENSOR_MODE_ACTIVE ?
+                                               SENSOR_MODE_IDLE : SENSOR_MODE_ACTIVE);
+                    }
+                }
+                etimer_reset(&mode_timer);
+            }
+        }
+    }
+    
+    PROCESS_END();
+}
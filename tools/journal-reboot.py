@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Reboot case for the mobile robot journal.
+
+  journal-reboot.py [--binary build/native/mobile-robot.native]
+
+Build the robot for native replay first:
+
+  make TARGET=native mobile-robot RADIO_REPLAY=1
+
+The robot is assigned one LA and discovers one idle sensor in the first grid.
+Grid 1 is Case 1, so the robot deploys from stock and collects that sensor.
+The robot is killed right after grid 1 commits to the journal, then booted again
+in the same directory (the journal lives in the native CFS files there) with
+an empty trace. The resumed robot must continue at grid 2, a Case 2 grid, and
+activate the collected sensor from its stock. That sensor id is only known
+from the journal.
+"""
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+from rtrace import MAGIC, RECORD_HEADER, VERSION
+
+NODE = 2
+BS_PORT = 5678     # UDP_SERVER_PORT
+ROBOT_PORT = 8765  # UDP_CLIENT_PORT
+LA_ID = 1
+LA_CENTER = (500, 500)
+SENSOR_ID = 20
+SENSOR_POS = (460, 460)  # grid 1 of the LA, more than SENSOR_PERCEPTION_RANGE from grid 2
+SENSOR_STATUS_IDLE = 0
+
+ROBOT_ASSIGNMENT = struct.Struct("<BxBxHHBx")  # robot_assignment_msg_t
+SENSOR_REPLY = struct.Struct("<BxHHBx")        # sensor_reply_msg_t
+BS_ADDR = bytes.fromhex("fd000000000000000201000100010001")
+ROBOT_ADDR = bytes.fromhex("fd000000000000000202000200020002")
+SENSOR_ADDR = bytes.fromhex("fd000000000000000214001400140014")
+
+COLLECTED = "Collected sensor %u from grid into stock" % SENSOR_ID
+COMMITTED = "Moving to next uncovered grid"
+ACTIVATED = "Activating collected sensor %u from stock" % SENSOR_ID
+
+
+def record(time_ms, src, src_port, payload):
+    return RECORD_HEADER.pack(time_ms, NODE, 0, len(payload), src_port, ROBOT_PORT,
+                              src, ROBOT_ADDR) + payload
+
+
+def write_trace(path, records):
+    with open(path, "wb") as trace:
+        trace.write(MAGIC + bytes([VERSION, 0, 0, 0]))
+        for rec in records:
+            trace.write(rec)
+
+
+def run(binary, workdir, trace, stop_after):
+    """Run the robot until stop_after has been printed after COLLECTED, or to the end."""
+    env = dict(os.environ, RADIO_REPLAY_FILE=trace, RADIO_REPLAY_NODE=str(NODE))
+    command = [binary]
+    if stop_after is not None and shutil.which("stdbuf"):
+        command = ["stdbuf", "-oL"] + command
+    proc = subprocess.Popen(command, cwd=workdir, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, text=True, errors="replace")
+    lines = []
+    collected = False
+    for line in proc.stdout:
+        lines.append(line.rstrip("\n"))
+        collected = collected or COLLECTED in line
+        if stop_after is not None and collected and stop_after in line:
+            proc.kill()
+            break
+    proc.wait()
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", default="build/native/mobile-robot.native")
+    parser.add_argument("--keep", action="store_true", help="keep the work directory")
+    args = parser.parse_args()
+
+    binary = os.path.abspath(args.binary)
+    if not os.access(binary, os.X_OK):
+        sys.exit("%s not found: make TARGET=native mobile-robot RADIO_REPLAY=1" % binary)
+
+    workdir = tempfile.mkdtemp(prefix="journal-reboot-")
+    first = os.path.join(workdir, "first.trace")
+    empty = os.path.join(workdir, "empty.trace")
+    # The robot id depends on the link-layer address, so assign the LA to both;
+    # the second assignment is ignored once the robot has left IDLE.
+    write_trace(first, [
+        record(1000, BS_ADDR, BS_PORT, ROBOT_ASSIGNMENT.pack(robot, LA_ID, *LA_CENTER, 4))
+        for robot in (0, 1)
+    ] + [
+        record(2500, SENSOR_ADDR, BS_PORT,
+               SENSOR_REPLY.pack(SENSOR_ID, *SENSOR_POS, SENSOR_STATUS_IDLE)),
+    ])
+    write_trace(empty, [])
+
+    failures = []
+    before = run(binary, workdir, first, COMMITTED)
+    if not any(COLLECTED in line for line in before):
+        failures.append("first boot never collected sensor %u" % SENSOR_ID)
+    elif not os.path.exists(os.path.join(workdir, "robot-journal")):
+        failures.append("no journal left after the first boot")
+    else:
+        after = run(binary, workdir, empty, None)
+        if not any("Journal: restored LA %u" % LA_ID in line for line in after):
+            failures.append("second boot did not restore LA %u from the journal" % LA_ID)
+        if not any(ACTIVATED in line for line in after):
+            failures.append("resumed robot never activated collected sensor %u" % SENSOR_ID)
+        before += ["--- reboot ---"] + after
+
+    if failures or args.keep:
+        print("\n".join(before))
+        print("work directory: %s" % workdir)
+    else:
+        shutil.rmtree(workdir)
+    for failure in failures:
+        print("FAIL: %s" % failure)
+    if failures:
+        sys.exit(1)
+    print("PASS: collected sensor %u activated after the reboot" % SENSOR_ID)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Extract a deployment outcome from a Cooja log for lifetime-sim.
+
+  lifetime-deployment.py LOG [-o deployment.csv]
+
+Every sensor-node mote's final position is taken from its log: the random
+position it starts at, then any deployment or relocation confirmed by a robot.
+A sensor is robot-deployed once a robot placed it, and in range of a robot
+once it has answered an Mp (it then sends status updates when active). The
+CSV columns are id,x,y,robot_deployed,robot_in_range, as read by
+LIFETIME_DEPLOYMENT=deployment.csv ./build/native/lifetime-sim.native
+"""
+import argparse
+import re
+import sys
+
+MOTE_LINE = re.compile(r"ID:(\d+)\s+(.*)$")
+STARTED = re.compile(r"Sensor Node \d+ (?:initialized at random position|randomly deployed at) "
+                     r"\((\d+), (\d+)\)")
+PLACED = re.compile(r"(?:now active at|Sensor relocated to) \((\d+), (\d+)\)")
+MP_RECEIVED = re.compile(r"Received Mp from Robot")
+
+
+def extract(path):
+    """{mote id: [x, y, robot_deployed, robot_in_range]} of the sensor motes"""
+    sensors = {}
+    with open(path, errors="replace") as log:
+        for line in log:
+            match = MOTE_LINE.search(line.rstrip())
+            if not match:
+                continue
+            mote, msg = int(match.group(1)), match.group(2)
+            started = STARTED.search(msg)
+            if started:
+                sensors.setdefault(mote, [0, 0, 0, 0])[:2] = [int(v) for v in started.groups()]
+                continue
+            if mote not in sensors:
+                continue
+            placed = PLACED.search(msg)
+            if placed:
+                sensors[mote][:3] = [int(v) for v in placed.groups()] + [1]
+            elif MP_RECEIVED.search(msg):
+                sensors[mote][3] = 1
+    return sensors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    sensors = extract(args.log)
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("id,x,y,robot_deployed,robot_in_range\n")
+    for mote in sorted(sensors):
+        out.write("%d,%d,%d,%d,%d\n" % ((mote,) + tuple(sensors[mote])))
+    if args.output:
+        out.close()
+        print("%d sensors -> %s" % (len(sensors), args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Convert a text obstacle map into obstacle-map-data.h for the base station.
+
+  obstacle-map.py [obstacle-map.txt] [-o obstacle-map-data.h]
+
+The text map covers the whole target area. The first line is y = 0, and all
+lines have the same length:
+
+  .   free
+  #   rubble: robots route around it, no sensor can be placed
+  ~   water: the same as rubble
+  x   robots pass, but no sensor can be placed
+
+The map is resampled (nearest cell) to TARGET_AREA_WIDTH / OBSTACLE_CELL by
+TARGET_AREA_HEIGHT / OBSTACLE_CELL cells, using the values in project-conf.h.
+Rerun the tool after changing the map or those parameters.
+"""
+import argparse
+import os
+import sys
+
+import wsnsim
+
+BLOCKED = "#~"
+NO_DEPLOY = "#~x"
+KNOWN = ".#~x"
+
+
+def read_map(path):
+    with open(path) as text:
+        rows = [line.rstrip("\n") for line in text if line.strip()]
+    if not rows or any(len(row) != len(rows[0]) for row in rows):
+        raise SystemExit("%s: rows must be non-empty and of equal length" % path)
+    unknown = set("".join(rows)) - set(KNOWN)
+    if unknown:
+        raise SystemExit("%s: unknown cell types %s" % (path, "".join(sorted(unknown))))
+    return rows
+
+
+def bitmap(rows, width, height, kinds):
+    """Row-major bits, least significant bit first, resampled to width x height"""
+    data = bytearray((width * height + 7) // 8)
+    for y in range(height):
+        row = rows[y * len(rows) // height]
+        for x in range(width):
+            if row[x * len(row) // width] in kinds:
+                index = y * width + x
+                data[index // 8] |= 1 << (index % 8)
+    return data
+
+
+def c_array(name, data):
+    lines = ["static const uint8_t %s[] = {" % name]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", nargs="?", default=os.path.join(wsnsim.PROJECT_DIR, "obstacle-map.txt"))
+    parser.add_argument("-o", "--output",
+                        default=os.path.join(wsnsim.PROJECT_DIR, "obstacle-map-data.h"))
+    args = parser.parse_args()
+
+    params = wsnsim.read_params(os.path.join(wsnsim.PROJECT_DIR, "project-conf.h"))
+    cell = params["OBSTACLE_CELL"]
+    width = int(params["TARGET_AREA_WIDTH"] // cell)
+    height = int(params["TARGET_AREA_HEIGHT"] // cell)
+    rows = read_map(args.map)
+
+    blocked = bitmap(rows, width, height, BLOCKED)
+    no_deploy = bitmap(rows, width, height, NO_DEPLOY)
+    with open(args.output, "w") as out:
+        out.write("/* Generated by tools/obstacle-map.py from %s - do not edit */\n"
+                  % os.path.basename(args.map))
+        out.write("#define OBSTACLE_MAP_DATA_WIDTH %d\n" % width)
+        out.write("#define OBSTACLE_MAP_DATA_HEIGHT %d\n\n" % height)
+        out.write(c_array("obstacle_map_blocked", blocked) + "\n\n")
+        out.write(c_array("obstacle_map_no_deploy", no_deploy) + "\n")
+
+    count = lambda data: sum(bin(b).count("1") for b in data)
+    print("%dx%d cells of %g m: %d blocked, %d not deployable -> %s"
+          % (width, height, cell, count(blocked), count(no_deploy), args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
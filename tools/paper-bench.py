@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Paper-conformance benchmark for the disaster WSN nodes.
+
+  paper-bench.py                           run every scenario in paper-bench.json
+  paper-bench.py -s canonical              run one scenario
+  paper-bench.py -s canonical --log FILE   check an existing Cooja log instead
+  paper-bench.py --record                  store the observed values as the baseline
+
+Each scenario is run headless in Cooja with a ScriptRunner that dumps all mote
+output, and the wall-clock time of the run is reported. The final PAPER_BS,
+PAPER_ROBOT and PAPER_SENSOR lines of every node are checked in three ways:
+
+  model     the firmware energies must equal the main.tex equations recomputed
+            from the node's cumulative counters and the constants in
+            project-conf.h (E_BS = processing + radio, E_robot = baseline +
+            radio + tau*D_p, E_active / E_idle for sensors, and
+            Per_AC = covered / (NO_G * NO_LA) * 100)
+  expected  closed-form values of the scenario, worked out by hand from the
+            paper and the scenario rather than from any firmware counter: the
+            last report time, node counts, NO_G * NO_LA, baseline energies
+            P * t and the sensing energy bound (t / 30 s) * mu * R^2; where
+            the route is fixed (one LA, no obstacle map) also Per_AC and the
+            total robot distance
+  baseline  coverage, robot distance and per-class energy must stay within
+            baseline_rel of the values recorded with --record; a scenario
+            without a recorded baseline fails
+
+A scenario's "params" override project-conf.h values for the model check. They
+must match the DEFINES the scenario's .csc builds the motes with.
+"""
+import argparse
+import json
+import os
+import sys
+import tempfile
+
+import wsnsim
+
+CONFIG = os.path.join(wsnsim.TOOLS_DIR, "paper-bench.json")
+
+SENSOR_MODE_ACTIVE = 1
+AVG_OP_TIME = 0.001  # avg_tx_time / avg_rx_time / avg_processing_time in the firmware
+
+
+class Checker:
+    def __init__(self, rel, abs_tol):
+        self.rel = rel
+        self.abs = abs_tol
+        self.failures = []
+        self.checks = 0
+
+    def close(self, what, observed, expected, rel=None):
+        self.checks += 1
+        rel = self.rel if rel is None else rel
+        if abs(observed - expected) > max(self.abs, rel * abs(expected)):
+            self.failures.append("%s: got %.9g, expected %.9g" % (what, observed, expected))
+
+
+def check_model(nodes, p, check):
+    bs = nodes["BS"]
+    if bs is None:
+        check.failures.append("no PAPER_BS line in the log")
+    else:
+        e_proc = bs["ops"] * p["P_PROCESSING_BASE"] * p["T_PROCESSING_BASE"]
+        e_radio = (bs["tx"] * p["P_TRANSMIT_BASE"] + bs["rx"] * p["P_RECEIVE_BASE"]) * AVG_OP_TIME
+        check.close("BS E_processing", bs["e_proc"], e_proc)
+        check.close("BS E_radio", bs["e_radio"], e_radio)
+        check.close("BS E_BS", bs["e_total"], e_proc + e_radio)
+
+        no_g = (p["ROBOT_PERCEPTION_RANGE"] // p["SENSOR_PERCEPTION_RANGE"]) ** 2
+        no_la = min((p["TARGET_AREA_WIDTH"] // p["ROBOT_PERCEPTION_RANGE"]) *
+                    (p["TARGET_AREA_HEIGHT"] // p["ROBOT_PERCEPTION_RANGE"]),
+                    p["MAX_LOCATION_AREAS"])
+        check.close("BS NO_G * NO_LA", bs["total_grids"], no_g * no_la, rel=0)
+        per_ac = bs["covered"] / (no_g * no_la) * 100.0 if no_g * no_la else 0.0
+        check.close("BS Per_AC", bs["per_ac"], per_ac)
+
+    for robot_id, r in sorted(nodes["ROBOT"].items()):
+        name = "robot %d" % robot_id
+        e_base = r["elapsed"] * p["P_BASELINE_ROBOT"]
+        e_radio = (r["tx"] * p["P_TRANSMIT_ROBOT"] + r["rx"] * p["P_RECEIVE_ROBOT"]) * AVG_OP_TIME
+        e_mob = p["TAU_MOBILITY"] * r["distance"]
+        check.close(name + " E_baseline", r["e_base"], e_base)
+        check.close(name + " E_radio", r["e_radio"], e_radio)
+        check.close(name + " tau * D_p", r["e_mob"], e_mob)
+        check.close(name + " E_robot", r["e_total"], e_base + e_radio + e_mob)
+
+    for sensor_id, s in sorted(nodes["SENSOR"].items()):
+        name = "sensor %d" % sensor_id
+        e_base = s["elapsed"] * p["P_BASELINE_SENSOR"]
+        e_sense = s["sensing"] * p["MU_SENSING"] * p["SENSOR_PERCEPTION_RANGE"] ** 2
+        e_proc = s["proc"] * p["P_PROCESSING_SENSOR"] * AVG_OP_TIME
+        e_radio = (s["tx"] * p["P_TRANSMIT_SENSOR"] + s["rx"] * p["P_RECEIVE_SENSOR"]) * AVG_OP_TIME
+        check.close(name + " E_baseline", s["e_base"], e_base)
+        check.close(name + " E_sensing", s["e_sense"], e_sense)
+        check.close(name + " E_processing", s["e_proc"], e_proc)
+        check.close(name + " E_radio", s["e_radio"], e_radio)
+        if int(s["mode"]) == SENSOR_MODE_ACTIVE:
+            check.close(name + " E_active", s["e_total"], e_base + e_sense + e_proc + e_radio)
+        else:
+            check.close(name + " E_idle", s["e_total"], e_base + e_radio)
+
+
+def check_expected(nodes, expected, check, rel, abs_s):
+    reports = ([("BS", nodes["BS"])] if nodes["BS"] else []) + \
+              [("robot %d" % i, r) for i, r in sorted(nodes["ROBOT"].items())] + \
+              [("sensor %d" % i, s) for i, s in sorted(nodes["SENSOR"].items())]
+    for name, report in reports:
+        check.checks += 1
+        if abs(report["elapsed"] - expected["report_elapsed_s"]) > abs_s:
+            check.failures.append("%s last report at %.3f s, expected %.1f s" %
+                                  (name, report["elapsed"], expected["report_elapsed_s"]))
+
+    check.close("robot count", len(nodes["ROBOT"]), expected["robots"], rel=0)
+    check.close("sensor count", len(nodes["SENSOR"]), expected["sensors"], rel=0)
+    if nodes["BS"]:
+        check.close("BS NO_G * NO_LA (closed form)", nodes["BS"]["total_grids"],
+                    expected["bs_total_grids"], rel=0)
+        if "per_ac" in expected:
+            check.close("BS Per_AC (closed form)", nodes["BS"]["per_ac"], expected["per_ac"], rel=rel)
+    if "robot_distance_m" in expected:
+        check.close("robot D_p total (closed form)",
+                    sum(r["distance"] for r in nodes["ROBOT"].values()),
+                    expected["robot_distance_m"], rel=rel)
+    for robot_id, r in sorted(nodes["ROBOT"].items()):
+        check.close("robot %d P_base * t" % robot_id, r["e_base"],
+                    expected["robot_e_baseline_j"], rel=rel)
+    for sensor_id, s in sorted(nodes["SENSOR"].items() if "sensor_e_baseline_j" in expected else []):
+        check.close("sensor %d P_base * t" % sensor_id, s["e_base"],
+                    expected["sensor_e_baseline_j"], rel=rel)
+        check.checks += 1
+        if s["e_sense"] > expected["sensor_e_sensing_max_j"] * (1 + rel):
+            check.failures.append("sensor %d E_sensing %.6f above the %.1f J bound" %
+                                  (sensor_id, s["e_sense"], expected["sensor_e_sensing_max_j"]))
+
+
+def check_baseline(summary, baseline, check):
+    for key, expected in sorted(baseline.items()):
+        if key in summary:
+            check.close("baseline " + key, summary[key], expected, rel=check.baseline_rel)
+
+
+def run_scenario(scenario, args):
+    with open(os.path.join(wsnsim.PROJECT_DIR, scenario["csc"])) as src:
+        csc = src.read()
+    workdir = tempfile.mkdtemp(prefix="paper-bench-%s-" % scenario["name"])
+    return wsnsim.run_cooja(csc, workdir, scenario["duration_s"], args.cooja, args.contiki)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-s", "--scenario", action="append",
+                        help="scenario name from paper-bench.json (default: all)")
+    parser.add_argument("--log", help="check this Cooja log instead of running the scenario")
+    parser.add_argument("--record", action="store_true",
+                        help="write the observed values as the new baseline")
+    parser.add_argument("--contiki", default=wsnsim.default_contiki(),
+                        help="Contiki-NG root (default: $CONTIKI)")
+    parser.add_argument("--cooja", default=None, help="cooja.jar (default: under --contiki)")
+    args = parser.parse_args()
+    if args.cooja is None:
+        args.cooja = wsnsim.default_cooja(args.contiki)
+
+    with open(CONFIG) as conf:
+        config = json.load(conf)
+    scenarios = [s for s in config["scenarios"]
+                 if not args.scenario or s["name"] in args.scenario]
+    if args.log and len(scenarios) != 1:
+        parser.error("--log needs exactly one --scenario")
+
+    params = wsnsim.read_params(os.path.join(wsnsim.PROJECT_DIR, "project-conf.h"))
+    tolerance = config["tolerance"]
+    failed = False
+
+    print("%-12s %8s %8s %8s %10s %12s %12s %12s  %s" %
+          ("scenario", "wall_s", "sim_s", "per_ac", "distance", "E_bs", "E_robots",
+           "E_sensors", "result"))
+    for scenario in scenarios:
+        if args.log:
+            log_path, wall = args.log, 0.0
+        else:
+            log_path, wall = run_scenario(scenario, args)
+
+        nodes = wsnsim.parse_paper_log(log_path)
+        check = Checker(tolerance["model_rel"], tolerance["model_abs"])
+        check.baseline_rel = tolerance["baseline_rel"]
+        check_model(nodes, dict(params, **scenario.get("params", {})), check)
+        check_expected(nodes, scenario["expected"], check, tolerance["expected_rel"],
+                       tolerance["expected_abs_s"])
+        summary = wsnsim.summarize(nodes)
+
+        if args.record:
+            scenario["baseline"] = summary
+        elif scenario.get("baseline"):
+            check_baseline(summary, scenario["baseline"], check)
+        else:
+            check.failures.append("no baseline recorded: run with --record on a reference run")
+
+        sim = nodes["BS"]["elapsed"] if nodes["BS"] else 0.0
+        result = "ok (%d checks)" % check.checks if not check.failures else \
+                 "FAIL (%d/%d)" % (len(check.failures), check.checks)
+        print("%-12s %8.1f %8.1f %8.2f %10.1f %12.6f %12.6f %12.6f  %s" %
+              (scenario["name"], wall, sim, summary["per_ac"], summary["robot_distance"],
+               summary["energy_bs"], summary["energy_robots"], summary["energy_sensors"], result))
+        for failure in check.failures:
+            print("    " + failure)
+        failed |= bool(check.failures)
+
+    if args.record:
+        with open(CONFIG, "w") as conf:
+            json.dump(config, conf, indent=2)
+            conf.write("\n")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
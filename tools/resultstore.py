@@ -0,0 +1,167 @@
+"""Columnar, memory-mapped result store for simulation runs.
+
+A store is a directory of tables; a table is a directory holding one file per
+column plus schema.json:
+
+  results.wsnr/runs/schema.json     {"rows": N, "columns": [{"name", "type", "dict"}]}
+  results.wsnr/runs/per_ac.col      N little-endian float64
+  results.wsnr/runs/status.col      N little-endian uint32 codes into "dict"
+
+Column types are "f" (float64), "i" (int64) and "s" (dictionary-encoded
+string, uint32 codes). Appends extend every column file and then rewrite
+schema.json; "rows" is the commit point, so bytes past it left by an
+interrupted append are ignored by readers and truncated by the next writer.
+Readers mmap the column files and see them as memoryviews without parsing.
+"""
+import json
+import math
+import mmap
+import os
+import struct
+
+TYPE_CODES = {"f": "d", "i": "q", "s": "I"}
+MISSING = {"f": math.nan, "i": -1, "s": None}
+
+RUNS = "runs"
+LAS = "las"
+NODES = "nodes"
+
+
+def _column_type(value):
+    if isinstance(value, bool) or isinstance(value, int):
+        return "i"
+    if isinstance(value, float):
+        return "f"
+    return "s"
+
+
+class TableWriter:
+    def __init__(self, store, table):
+        self.path = os.path.join(store, table)
+        os.makedirs(self.path, exist_ok=True)
+        self.schema = {"rows": 0, "columns": []}
+        schema_path = os.path.join(self.path, "schema.json")
+        if os.path.exists(schema_path):
+            with open(schema_path) as schema:
+                self.schema = json.load(schema)
+        self.columns = {c["name"]: c for c in self.schema["columns"]}
+        self.codes = {c["name"]: {w: i for i, w in enumerate(c["dict"])}
+                      for c in self.schema["columns"] if c["type"] == "s"}
+
+    def _add_column(self, name, kind):
+        column = {"name": name, "type": kind}
+        if kind == "s":
+            column["dict"] = []
+            self.codes[name] = {}
+        self.schema["columns"].append(column)
+        self.columns[name] = column
+        with open(self._file(name), "wb") as out:
+            if self.schema["rows"]:
+                out.write(self._encode(column, MISSING[kind]) * self.schema["rows"])
+
+    def _file(self, name):
+        return os.path.join(self.path, name + ".col")
+
+    def _encode(self, column, value):
+        kind = column["type"]
+        if kind == "s":
+            value = "" if value is None else str(value)
+            codes = self.codes[column["name"]]
+            if value not in codes:
+                codes[value] = len(column["dict"])
+                column["dict"].append(value)
+            value = codes[value]
+        elif value is None:
+            value = MISSING[kind]
+        elif kind == "i":
+            value = int(value)
+        else:
+            value = float(value)
+        return struct.pack("<" + TYPE_CODES[kind], value)
+
+    def append(self, rows):
+        """Append dict rows; new keys become columns, missing keys are NaN/-1/''"""
+        if not rows:
+            return
+        for row in rows:
+            for name, value in row.items():
+                if name not in self.columns and value is not None:
+                    self._add_column(name, _column_type(value))
+        rows_before = self.schema["rows"]
+        for name, column in self.columns.items():
+            size = rows_before * struct.calcsize(TYPE_CODES[column["type"]])
+            with open(self._file(name), "r+b") as out:
+                out.truncate(size)
+                out.seek(size)
+                out.write(b"".join(self._encode(column, row.get(name)) for row in rows))
+        self.schema["rows"] = rows_before + len(rows)
+        tmp = os.path.join(self.path, "schema.json.tmp")
+        with open(tmp, "w") as schema:
+            json.dump(self.schema, schema)
+        os.replace(tmp, os.path.join(self.path, "schema.json"))
+
+
+class Table:
+    def __init__(self, store, table):
+        self.path = os.path.join(store, table)
+        with open(os.path.join(self.path, "schema.json")) as schema:
+            self.schema = json.load(schema)
+        self.rows = self.schema["rows"]
+        self.names = [c["name"] for c in self.schema["columns"]]
+        self._columns = {c["name"]: c for c in self.schema["columns"]}
+        self._maps = {}
+
+    def kind(self, name):
+        return self._columns[name]["type"]
+
+    def raw(self, name):
+        """Column as a memoryview over the mmapped file (codes for strings)"""
+        kind = self._columns[name]["type"]
+        if self.rows == 0:
+            return memoryview(b"").cast(TYPE_CODES[kind])
+        if name not in self._maps:
+            with open(os.path.join(self.path, name + ".col"), "rb") as col:
+                self._maps[name] = mmap.mmap(col.fileno(), 0, access=mmap.ACCESS_READ)
+        size = self.rows * struct.calcsize(TYPE_CODES[kind])
+        return memoryview(self._maps[name])[:size].cast(TYPE_CODES[kind])
+
+    def dictionary(self, name):
+        return self._columns[name].get("dict", [])
+
+    def values(self, name):
+        """Column as Python values, strings decoded"""
+        raw = self.raw(name)
+        if self.kind(name) == "s":
+            words = self.dictionary(name)
+            return [words[code] for code in raw]
+        return raw
+
+
+def tables(store):
+    return sorted(t for t in os.listdir(store)
+                  if os.path.exists(os.path.join(store, t, "schema.json")))
+
+
+def append_runs(store, runs):
+    """Store (run, nodes) pairs: `run` holds the parameters and summary and
+    `nodes` is wsnsim.parse_paper_log() output, or None. Returns the run_ids."""
+    run_table = TableWriter(store, RUNS)
+    first = run_table.schema["rows"]
+    run_rows, node_rows, la_rows = [], [], []
+    for run_id, (run, nodes) in enumerate(runs, first):
+        run_rows.append(dict(run, run_id=run_id))
+        if nodes is None:
+            continue
+        if nodes["BS"]:
+            node_rows.append(dict(nodes["BS"], run_id=run_id, kind="bs", id=1))
+        for kind in ("ROBOT", "SENSOR"):
+            for record in nodes[kind].values():
+                node_rows.append(dict(record, run_id=run_id, kind=kind.lower(),
+                                      id=int(record["id"])))
+        for la in nodes["LA"].values():
+            la_rows.append(dict({k: int(v) for k, v in la.items()}, run_id=run_id))
+    # runs first, so run_ids are never reused by an append after an interruption
+    run_table.append(run_rows)
+    TableWriter(store, NODES).append(node_rows)
+    TableWriter(store, LAS).append(la_rows)
+    return list(range(first, first + len(run_rows)))
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Query and fill the columnar result store (see resultstore.py).
+
+  rstore.py ingest STORE LOG... [-p KEY=VALUE]...   add Cooja logs as runs
+  rstore.py describe STORE                          tables, rows and columns
+  rstore.py query STORE [-t TABLE] [-w FILTER]... [-g COLS] [-a AGGS] [--csv]
+
+Tables: runs (one row per run: parameters and summary), nodes (final PAPER_*
+report of every BS, robot and sensor) and las (final per-LA state). Detail
+rows carry run_id, and columns of runs (e.g. sweep parameters) can be used in
+filters and group-bys on nodes and las directly.
+
+  FILTER  COL=VALUE, COL!=VALUE, COL<VALUE, COL<=VALUE, COL>VALUE, COL>=VALUE
+  AGGS    count, and sum|mean|min|max|pNN of a column, e.g. mean:per_ac,p99:e_total
+
+  rstore.py query sweep-out/results.wsnr -w status=ok -g ROBOT_PERCEPTION_RANGE \\
+      -a count,mean:per_ac,p10:per_ac,p90:energy_robots
+  rstore.py query sweep-out/results.wsnr -t nodes -w kind=sensor -g NUM_SENSORS -a p50:e_total
+"""
+import argparse
+import math
+import operator
+import re
+import sys
+
+import resultstore
+import wsnsim
+
+FILTER = re.compile(r"^(\w+)(=|!=|<=|>=|<|>)(.*)$")
+OPERATORS = {"=": operator.eq, "!=": operator.ne, "<": operator.lt, "<=": operator.le,
+             ">": operator.gt, ">=": operator.ge}
+
+
+class View:
+    """A table plus the runs columns reachable through run_id"""
+    def __init__(self, store, table):
+        self.table = resultstore.Table(store, table)
+        self.runs = None
+        if table != resultstore.RUNS and "run_id" in self.table.names:
+            self.runs = resultstore.Table(store, resultstore.RUNS)
+        self.cache = {}
+
+    def column(self, name):
+        if name in self.cache:
+            return self.cache[name]
+        if name in self.table.names:
+            values = self.table.values(name)
+        elif self.runs is not None and name in self.runs.names:
+            run_values = self.runs.values(name)
+            values = [run_values[run_id] for run_id in self.table.raw("run_id")]
+        else:
+            raise SystemExit("no column %s" % name)
+        self.cache[name] = values
+        return values
+
+    def kind(self, name):
+        if name in self.table.names:
+            return self.table.kind(name)
+        return self.runs.kind(name)
+
+
+def select(view, filters):
+    selected = range(view.table.rows)
+    for expr in filters:
+        match = FILTER.match(expr)
+        if not match:
+            raise SystemExit("bad filter %s" % expr)
+        name, op, text = match.groups()
+        values = view.column(name)
+        value = text if view.kind(name) == "s" else float(text)
+        test = OPERATORS[op]
+        selected = [i for i in selected if test(values[i], value)]
+    return selected
+
+
+def percentile(values, p):
+    """Linear interpolation between closest ranks"""
+    if not values:
+        return math.nan
+    values = sorted(values)
+    rank = (len(values) - 1) * p / 100.0
+    low = int(rank)
+    high = min(low + 1, len(values) - 1)
+    return values[low] + (values[high] - values[low]) * (rank - low)
+
+
+def aggregate(spec, values):
+    values = [v for v in values if not (isinstance(v, float) and math.isnan(v))]
+    if spec == "sum":
+        return sum(values)
+    if spec == "mean":
+        return sum(values) / len(values) if values else math.nan
+    if spec == "min":
+        return min(values) if values else math.nan
+    if spec == "max":
+        return max(values) if values else math.nan
+    if spec.startswith("p"):
+        return percentile(values, float(spec[1:]))
+    raise SystemExit("unknown aggregate %s" % spec)
+
+
+def query(args):
+    view = View(args.store, args.table)
+    rows = select(view, args.where or [])
+    groups = [g for g in (args.group_by or "").split(",") if g]
+    aggs = [a for a in args.aggregate.split(",") if a]
+
+    grouped = {}
+    key_columns = [view.column(g) for g in groups]
+    for i in rows:
+        grouped.setdefault(tuple(c[i] for c in key_columns), []).append(i)
+
+    header = groups + aggs
+    table = []
+    for key in sorted(grouped):
+        members = grouped[key]
+        out = list(key)
+        for agg in aggs:
+            if agg == "count":
+                out.append(len(members))
+                continue
+            spec, _, name = agg.partition(":")
+            values = view.column(name)
+            out.append(aggregate(spec, [values[i] for i in members]))
+        table.append(out)
+    print_table(header, table, args.csv)
+
+
+def print_table(header, rows, as_csv):
+    def fmt(value):
+        if isinstance(value, float):
+            return "%.6g" % value
+        return str(value)
+    cells = [[fmt(v) for v in row] for row in rows]
+    if as_csv:
+        print(",".join(header))
+        for row in cells:
+            print(",".join(row))
+        return
+    widths = [max([len(h)] + [len(row[i]) for row in cells]) for i, h in enumerate(header)]
+    print("  ".join(h.rjust(w) for h, w in zip(header, widths)))
+    for row in cells:
+        print("  ".join(c.rjust(w) for c, w in zip(row, widths)))
+
+
+def describe(args):
+    for name in resultstore.tables(args.store):
+        table = resultstore.Table(args.store, name)
+        print("%s: %d rows" % (name, table.rows))
+        for column in table.names:
+            extra = ""
+            if table.kind(column) == "s":
+                extra = " (%d distinct)" % len(table.dictionary(column))
+            print("    %-28s %s%s" % (column, table.kind(column), extra))
+
+
+def parse_value(text):
+    for convert in (int, float):
+        try:
+            return convert(text)
+        except ValueError:
+            pass
+    return text
+
+
+def ingest(args):
+    params = {}
+    for param in args.param or []:
+        key, _, value = param.partition("=")
+        params[key] = parse_value(value)
+    runs = []
+    for log in args.logs:
+        nodes = wsnsim.parse_paper_log(log)
+        run = dict(params, log=log, status="ok" if nodes["BS"] else "no-report",
+                   sim_s=nodes["BS"]["elapsed"] if nodes["BS"] else 0.0)
+        run.update(wsnsim.summarize(nodes))
+        runs.append((run, nodes))
+    run_ids = resultstore.append_runs(args.store, runs)
+    for log, run_id in zip(args.logs, run_ids):
+        print("%s -> run %d" % (log, run_id))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("ingest", help="add Cooja logs to a store")
+    p.add_argument("store")
+    p.add_argument("logs", nargs="+")
+    p.add_argument("-p", "--param", action="append", help="KEY=VALUE stored with each run")
+    p.set_defaults(func=ingest)
+
+    p = sub.add_parser("describe", help="list tables and columns")
+    p.add_argument("store")
+    p.set_defaults(func=describe)
+
+    p = sub.add_parser("query", help="filter, group and aggregate a table")
+    p.add_argument("store")
+    p.add_argument("-t", "--table", default=resultstore.RUNS)
+    p.add_argument("-w", "--where", action="append", help="filter, may be repeated")
+    p.add_argument("-g", "--group-by", help="comma-separated columns")
+    p.add_argument("-a", "--aggregate", default="count", help="comma-separated aggregates")
+    p.add_argument("--csv", action="store_true")
+    p.set_defaults(func=query)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Radio trace tool for the disaster WSN nodes.
+
+  rtrace.py extract LOG -o radio.trace [--node N]   RTRACE log lines -> binary trace
+  rtrace.py dump radio.trace                         print a binary trace
+
+The binary layout matches radio-trace.h: an 8-byte file header ("RTRC",
+version, 3 reserved bytes) followed by records of time_ms u32, node u8,
+flags u8, len u16, src_port u16, dst_port u16, src[16], dst[16] and the
+payload. node is the receiving node's Contiki node_id, the mote ID Cooja
+shows, so --node 2 keeps what mote 2 received. Records flagged truncated
+are kept but skipped by the replay.
+"""
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"RTRC"
+VERSION = 2
+RECORD_HEADER = struct.Struct("<IBBHHH16s16s")
+FLAG_MULTICAST = 0x01
+FLAG_TRUNCATED = 0x02
+
+RTRACE_LINE = re.compile(r"RTRACE ([0-9a-fA-F]+)")
+
+
+def extract(args):
+    count = 0
+    truncated = 0
+    with open(args.log, "r", errors="replace") as log, open(args.output, "wb") as out:
+        out.write(MAGIC + bytes([VERSION, 0, 0, 0]))
+        for line in log:
+            match = RTRACE_LINE.search(line)
+            if not match:
+                continue
+            record = bytes.fromhex(match.group(1))
+            if len(record) < RECORD_HEADER.size:
+                continue
+            _, node, flags, length, _, _, _, _ = RECORD_HEADER.unpack_from(record)
+            if len(record) != RECORD_HEADER.size + length:
+                print("skipping truncated record: %s" % line.strip(), file=sys.stderr)
+                continue
+            if args.node is not None and node != args.node:
+                continue
+            out.write(record)
+            count += 1
+            truncated += bool(flags & FLAG_TRUNCATED)
+    print("%d records written to %s" % (count, args.output))
+    if truncated:
+        print("%d records exceed RADIO_TRACE_MAX_PAYLOAD and will not be replayed" % truncated,
+              file=sys.stderr)
+
+
+def dump(args):
+    with open(args.trace, "rb") as trace:
+        header = trace.read(8)
+        if header[:4] != MAGIC or header[4] != VERSION:
+            sys.exit("%s: not a version %d radio trace" % (args.trace, VERSION))
+        while True:
+            raw = trace.read(RECORD_HEADER.size)
+            if len(raw) < RECORD_HEADER.size:
+                break
+            time_ms, node, flags, length, src_port, dst_port, src, dst = RECORD_HEADER.unpack(raw)
+            payload = trace.read(length)
+            print("%10u node %3u %s src ..%s:%u dst ..%s:%u len %3u%s %s" % (
+                time_ms, node, "mcast" if flags & FLAG_MULTICAST else "ucast",
+                src[-4:].hex(), src_port, dst[-4:].hex(), dst_port, length,
+                " (truncated)" if flags & FLAG_TRUNCATED else "", payload.hex()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("extract", help="convert RTRACE log lines into a binary trace")
+    p.add_argument("log")
+    p.add_argument("-o", "--output", default="radio.trace")
+    p.add_argument("--node", type=int,
+                   help="keep only records delivered to this node_id (Cooja mote ID)")
+    p.set_defaults(func=extract)
+
+    p = sub.add_parser("dump", help="print a binary trace")
+    p.add_argument("trace")
+    p.set_defaults(func=dump)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""Parameter sweep driver for the disaster WSN simulation.
+
+  sweep.py SPEC.json -o OUT [--build-jobs N] [--run-jobs N]
+
+SPEC names a Cooja scenario and a grid of values. Grid keys are project-conf.h
+#defines (e.g. ROBOT_PERCEPTION_RANGE, ROBOT_STOCK_CAPACITY), plus NUM_SENSORS,
+which regenerates the scenario's sensor motes at seeded random positions:
+
+  {
+    "scenario": "disaster-wsn-cooja.csc",
+    "duration_s": 600,
+    "seeds": [1, 2],
+    "grid": {"ROBOT_PERCEPTION_RANGE": [100, 200], "NUM_SENSORS": [12, 48]}
+  }
+
+Every distinct set of #define values is built once, in parallel, into
+OUT/builds/<hash>/: a copy of the project with its own project-conf.h. Each
+(point, seed) is then simulated concurrently in OUT/runs/<hash>/, from its own
+copy of the built variant in OUT/runs/<hash>/firmware/: Cooja re-runs the
+scenario's make step there, which finds everything up to date and cannot race
+with other runs of the same variant. The PAPER_*
+results of all runs are collected into OUT/results.csv and the columnar store
+OUT/results.wsnr (query it with rstore.py). Finished builds and runs are kept,
+so an interrupted sweep resumes where it stopped.
+"""
+import argparse
+import concurrent.futures
+import csv
+import glob
+import hashlib
+import itertools
+import json
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+
+import resultstore
+import wsnsim
+
+SCENARIO_KEYS = ("NUM_SENSORS",)
+PROJECT_PATH = "[CONTIKI_DIR]/examples/disaster-wsn-deployment/"
+FIRST_SENSOR_ID = 4
+
+MOTE = re.compile(r"[ \t]*(<!--[^\n]*-->\s*)?<mote>.*?</mote>\n", re.S)
+SENSOR_MOTE = """    <mote>
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>%.1f</x>
+        <y>%.1f</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.contikimote.interfaces.ContikiMoteID
+        <id>%d</id>
+      </interface_config>
+      <motetype_identifier>sensor_node_type</motetype_identifier>
+    </mote>
+"""
+
+
+def point_hash(values):
+    return hashlib.sha1(json.dumps(values, sort_keys=True).encode()).hexdigest()[:10]
+
+
+def expand_grid(spec, defines):
+    keys = sorted(spec["grid"])
+    for key in keys:
+        if key not in SCENARIO_KEYS and key not in defines:
+            raise SystemExit("%s is not a numeric #define in project-conf.h" % key)
+    for combo in itertools.product(*(spec["grid"][k] for k in keys)):
+        yield dict(zip(keys, combo))
+
+
+def write_project_conf(src, dst, defines):
+    with open(src) as conf:
+        text = conf.read()
+    for name, value in defines.items():
+        text, count = re.subn(r"^(\s*#define\s+%s\s+)\S+" % name,
+                              lambda m: m.group(1) + str(value), text, count=1, flags=re.M)
+        assert count == 1, name
+    with open(dst, "w") as conf:
+        conf.write(text)
+
+
+def prepare_build(defines, build_dir, contiki):
+    """Project copy with its own project-conf.h and an absolute CONTIKI"""
+    os.makedirs(build_dir, exist_ok=True)
+    for path in glob.glob(os.path.join(wsnsim.PROJECT_DIR, "*.[ch]")):
+        shutil.copy(path, build_dir)
+    write_project_conf(os.path.join(wsnsim.PROJECT_DIR, "project-conf.h"),
+                       os.path.join(build_dir, "project-conf.h"), defines)
+    with open(os.path.join(wsnsim.PROJECT_DIR, "Makefile")) as makefile:
+        text = makefile.read()
+    text = re.sub(r"^CONTIKI = .*$", "CONTIKI = " + os.path.abspath(contiki), text, flags=re.M)
+    with open(os.path.join(build_dir, "Makefile"), "w") as makefile:
+        makefile.write(text)
+
+
+def build(defines, build_dir, targets, args):
+    stamp = os.path.join(build_dir, "build.ok")
+    if os.path.exists(stamp):
+        return build_dir
+    prepare_build(defines, build_dir, args.contiki)
+    jobs = max(1, (os.cpu_count() or 1) // args.build_jobs)
+    with open(os.path.join(build_dir, "build.log"), "w") as log:
+        result = subprocess.run(["make", "-j%d" % jobs, "TARGET=cooja"] + targets,
+                                cwd=build_dir, stdout=log, stderr=subprocess.STDOUT)
+    if result.returncode != 0:
+        raise RuntimeError("build failed, see %s" % os.path.join(build_dir, "build.log"))
+    with open(stamp, "w") as out:
+        json.dump(defines, out, sort_keys=True)
+    return build_dir
+
+
+def make_scenario(csc, firmware_dir, point, seed, params):
+    csc = csc.replace(PROJECT_PATH, firmware_dir + "/")
+    csc = re.sub(r"<randomseed>\d+</randomseed>", "<randomseed>%d</randomseed>" % seed, csc)
+    if "NUM_SENSORS" in point:
+        csc = MOTE.sub(lambda m: "" if "sensor_node_type" in m.group(0) else m.group(0), csc)
+        rng = random.Random(seed)
+        motes = "".join(SENSOR_MOTE % (rng.uniform(0, params["TARGET_AREA_WIDTH"]),
+                                       rng.uniform(0, params["TARGET_AREA_HEIGHT"]),
+                                       FIRST_SENSOR_ID + i)
+                        for i in range(int(point["NUM_SENSORS"])))
+        csc = csc.replace("  </simulation>", motes + "  </simulation>", 1)
+    return csc
+
+
+def simulate(run, csc, args):
+    run_dir, point, seed = run["dir"], run["point"], run["seed"]
+    result_path = os.path.join(run_dir, "result.json")
+    if os.path.exists(result_path):
+        with open(result_path) as result:
+            return json.load(result)
+    os.makedirs(run_dir, exist_ok=True)
+    row = dict(point, seed=seed)
+    # copy2 keeps mtimes, so the csc make step sees the prebuilt objects as current
+    shutil.copytree(run["build_dir"], run["firmware_dir"], dirs_exist_ok=True)
+    try:
+        log_path, wall = wsnsim.run_cooja(csc, run_dir, run["duration_s"], args.cooja, args.contiki)
+        nodes = wsnsim.parse_paper_log(log_path)
+        row.update(wsnsim.summarize(nodes), wall_s=round(wall, 1),
+                   sim_s=nodes["BS"]["elapsed"] if nodes["BS"] else 0.0,
+                   status="ok" if nodes["BS"] else "no-report")
+    except RuntimeError as err:
+        print(err, file=sys.stderr)
+        return dict(row, status="failed")  # Not cached, retried on the next invocation
+    with open(result_path, "w") as result:
+        json.dump(row, result, sort_keys=True)
+    return row
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("spec", help="sweep specification (JSON)")
+    parser.add_argument("-o", "--output", required=True, help="sweep output directory")
+    parser.add_argument("--build-jobs", type=int, default=4, help="variants built at once")
+    parser.add_argument("--run-jobs", type=int, default=os.cpu_count() or 1,
+                        help="Cooja simulations run at once")
+    parser.add_argument("--contiki", default=wsnsim.default_contiki(),
+                        help="Contiki-NG root (default: $CONTIKI)")
+    parser.add_argument("--cooja", default=None, help="cooja.jar (default: under --contiki)")
+    args = parser.parse_args()
+    if args.cooja is None:
+        args.cooja = wsnsim.default_cooja(args.contiki)
+    args.contiki = os.path.abspath(args.contiki)
+    output = os.path.abspath(args.output)
+
+    with open(args.spec) as spec_file:
+        spec = json.load(spec_file)
+    with open(os.path.join(wsnsim.PROJECT_DIR, spec["scenario"])) as csc_file:
+        csc = csc_file.read()
+    targets = sorted(set(re.findall(r"\$\(MAKE\)[^<]*?(\S+\.cooja)", csc)))
+    base_params = wsnsim.read_params(os.path.join(wsnsim.PROJECT_DIR, "project-conf.h"))
+
+    points = list(expand_grid(spec, base_params))
+    variants = {}
+    runs = []
+    for point in points:
+        defines = {k: v for k, v in point.items() if k not in SCENARIO_KEYS}
+        variant = point_hash(defines)
+        variants[variant] = defines
+        for seed in spec.get("seeds", [1]):
+            runs.append({"point": point, "seed": seed, "variant": variant,
+                         "duration_s": spec["duration_s"],
+                         "dir": os.path.join(output, "runs", point_hash(dict(point, seed=seed)))})
+    print("%d points x %d seeds = %d runs, %d firmware variants" %
+          (len(points), len(spec.get("seeds", [1])), len(runs), len(variants)))
+
+    failed_variants = set()
+    with concurrent.futures.ThreadPoolExecutor(args.build_jobs) as pool:
+        futures = {pool.submit(build, defines, os.path.join(output, "builds", variant),
+                               targets, args): variant
+                   for variant, defines in variants.items()}
+        for future in concurrent.futures.as_completed(futures):
+            try:
+                future.result()
+            except RuntimeError as err:
+                print(err, file=sys.stderr)
+                failed_variants.add(futures[future])
+    print("%d/%d variants built" % (len(variants) - len(failed_variants), len(variants)))
+
+    rows = []
+    with concurrent.futures.ThreadPoolExecutor(args.run_jobs) as pool:
+        futures = {}
+        for run in runs:
+            if run["variant"] in failed_variants:
+                rows.append((dict(run["point"], seed=run["seed"], status="build-failed"), run))
+                continue
+            run["build_dir"] = os.path.join(output, "builds", run["variant"])
+            run["firmware_dir"] = os.path.join(run["dir"], "firmware")
+            params = dict(base_params, **variants[run["variant"]])
+            scenario = make_scenario(csc, run["firmware_dir"], run["point"], run["seed"], params)
+            futures[pool.submit(simulate, run, scenario, args)] = run
+        for done, future in enumerate(concurrent.futures.as_completed(futures), 1):
+            rows.append((future.result(), futures[future]))
+            print("\r%d/%d runs" % (done, len(futures)), end="", flush=True)
+    print()
+    rows.sort(key=lambda item: [item[0].get(k, 0) for k in sorted(spec["grid"])] +
+                               [item[0]["seed"]])
+
+    # The store is rebuilt from the run directories, so resumed runs are not duplicated
+    store = os.path.join(output, "results.wsnr")
+    shutil.rmtree(store, ignore_errors=True)
+    resultstore.append_runs(store, [
+        (row, wsnsim.parse_paper_log(os.path.join(run["dir"], "COOJA.testlog"))
+              if row["status"] != "build-failed" and
+              os.path.exists(os.path.join(run["dir"], "COOJA.testlog")) else None)
+        for row, run in rows])
+    rows = [row for row, _ in rows]
+
+    keys = sorted(spec["grid"]) + ["seed", "status", "wall_s", "sim_s", "per_ac",
+                                   "robot_distance", "energy_bs", "energy_robots",
+                                   "energy_sensors"]
+    with open(os.path.join(output, "results.csv"), "w", newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=keys, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(rows)
+    print("results: %s, %s" % (os.path.join(output, "results.csv"), store))
+    return 0 if all(row["status"] == "ok" for row in rows) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
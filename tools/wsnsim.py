@@ -0,0 +1,108 @@
+"""Shared helpers for the disaster WSN host tools: project-conf.h parsing,
+headless Cooja runs and PAPER_* report parsing."""
+import os
+import re
+import subprocess
+import time
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_DIR = os.path.dirname(TOOLS_DIR)
+
+PAPER_LINE = re.compile(r"PAPER_(BS|ROBOT|SENSOR|LA), (.*)$")
+DEFINE = re.compile(r"^\s*#define\s+(\w+)\s+\(?([-+0-9.eE]+)\)?\s*(//.*)?$")
+
+PAPER_FIELDS = {
+    "BS": ("elapsed", "ops", "tx", "rx", "e_proc", "e_radio", "e_total",
+           "per_ac", "covered", "total_grids"),
+    "ROBOT": ("id", "elapsed", "tx", "rx", "distance", "e_base", "e_radio",
+              "e_mob", "e_total"),
+    "SENSOR": ("id", "mode", "elapsed", "sensing", "proc", "tx", "rx", "e_base",
+               "e_sense", "e_proc", "e_radio", "e_total"),
+    "LA": ("id", "center_x", "center_y", "no_grid", "robot"),
+}
+
+SCRIPT_RUNNER = """  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(%d, log.testOK());
+while (true) {
+  log.log(time + "\\tID:" + id + "\\t" + msg + "\\n");
+  YIELD();
+}</script>
+      <active>true</active>
+    </plugin_config>
+  </plugin>
+"""
+
+
+def read_params(path):
+    """Numeric #defines of a project-conf.h"""
+    params = {}
+    with open(path) as conf:
+        for line in conf:
+            match = DEFINE.match(line)
+            if match:
+                params[match.group(1)] = float(match.group(2))
+    return params
+
+
+def default_contiki():
+    return os.environ.get("CONTIKI", os.path.join(PROJECT_DIR, "..", ".."))
+
+
+def default_cooja(contiki):
+    return os.path.join(contiki, "tools", "cooja", "dist", "cooja.jar")
+
+
+def run_cooja(csc, workdir, duration_s, cooja, contiki):
+    """Run simulation XML `csc` headless for duration_s in workdir.
+    Returns the path of the mote output log and the wall-clock seconds."""
+    csc = csc.replace("</simconf>", SCRIPT_RUNNER % int(duration_s * 1000) + "</simconf>")
+    csc_path = os.path.join(workdir, "simulation.csc")
+    with open(csc_path, "w") as out:
+        out.write(csc)
+
+    cmd = ["java", "-jar", cooja, "-nogui=" + csc_path, "-contiki=" + contiki]
+    start = time.monotonic()
+    with open(os.path.join(workdir, "cooja.out"), "w") as out:
+        result = subprocess.run(cmd, cwd=workdir, stdout=out, stderr=subprocess.STDOUT)
+    wall = time.monotonic() - start
+    log_path = os.path.join(workdir, "COOJA.testlog")
+    if result.returncode != 0 or not os.path.exists(log_path):
+        raise RuntimeError("Cooja failed (exit %d), see %s" %
+                           (result.returncode, os.path.join(workdir, "cooja.out")))
+    return log_path, wall
+
+
+def parse_paper_log(path):
+    """Last PAPER_* report of every node (and LA) in a Cooja log"""
+    nodes = {"BS": None, "ROBOT": {}, "SENSOR": {}, "LA": {}}
+    with open(path, errors="replace") as log:
+        for line in log:
+            match = PAPER_LINE.search(line.rstrip())
+            if not match:
+                continue
+            kind = match.group(1)
+            fields = PAPER_FIELDS[kind]
+            values = [float(v) for v in match.group(2).split(",")]
+            if len(values) != len(fields):
+                continue
+            record = dict(zip(fields, values))
+            if kind == "BS":
+                nodes["BS"] = record
+            else:
+                nodes[kind][int(record["id"])] = record
+    return nodes
+
+
+def summarize(nodes):
+    bs = nodes["BS"] or {}
+    robots = nodes["ROBOT"].values()
+    sensors = nodes["SENSOR"].values()
+    return {
+        "per_ac": bs.get("per_ac", 0.0),
+        "robot_distance": sum(r["distance"] for r in robots),
+        "energy_bs": bs.get("e_total", 0.0),
+        "energy_robots": sum(r["e_total"] for r in robots),
+        "energy_sensors": sum(s["e_total"] for s in sensors),
+    }